@@ -1 +1,2 @@
-./build/emulator/emulator Roms/Invaders/invaders > build/emulator/emulator.txt
+./build/emulator/emulator -f 30 -t build/emulator/emulator.trace Roms/invaders/invaders
+./build/emulator/tracedump build/emulator/emulator.trace > build/emulator/emulator.txt
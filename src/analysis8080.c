@@ -0,0 +1,186 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "analysis8080.h"
+#include "opcodes8080.h"
+
+const char *const xrefTypes8080[XREF_TYPE_COUNT8080] =
+{
+    "call", "jump", "branch", "rst", "read", "write", "pointer"
+};
+
+// State of one analysis while it runs
+typedef struct
+{
+    Analysis8080 *a;
+    uint32_t *worklist;
+    uint8_t *queued;        // One flag per byte of the image, set once queued
+    int pending;
+    int capacity;           // Of a->xrefs
+} Walk8080;
+
+
+static int addXref8080(Walk8080 *w, uint16_t from, uint16_t to, uint8_t type)
+{
+    Analysis8080 *a = w->a;
+
+    if (a->xrefCount == w->capacity)
+    {
+        w->capacity = w->capacity ? w->capacity * 2 : 1024;
+        Xref8080 *grown = realloc(a->xrefs, w->capacity * sizeof(Xref8080));
+        if (grown == NULL) return 0;
+        a->xrefs = grown;
+    }
+    a->xrefs[a->xrefCount++] = (Xref8080) { from, to, type };
+
+    if (to < a->size)
+    {
+        switch (type)
+        {
+            case XREF_CALL8080: case XREF_RST8080: a->bytes[to] |= BYTE_SUBROUTINE8080; break;
+            case XREF_JUMP8080: case XREF_BRANCH8080: a->bytes[to] |= BYTE_LABEL8080; break;
+            default: a->bytes[to] |= BYTE_DATA_LABEL8080; break;
+        }
+    }
+    return 1;
+}
+
+static void queue8080(Walk8080 *w, uint32_t address)
+{
+    // Each address is queued at most once, so the worklist's one slot per byte
+    // always has room
+    if (address >= w->a->size || w->queued[address] || (w->a->bytes[address] & BYTE_START8080)) return;
+    w->queued[address] = 1;
+    w->worklist[w->pending++] = address;
+}
+
+// Decode straight-line code from address until control leaves it, queueing the
+// static targets on the way
+static int trace8080(Walk8080 *w, uint32_t address)
+{
+    Analysis8080 *a = w->a;
+
+    while (address < a->size && !(a->bytes[address] & BYTE_START8080))
+    {
+        const uint8_t *instruction = &a->image[address];
+        const Opcode8080 *op = &opcodes8080[instruction[0]];
+        uint32_t next = address + op->length;
+        uint16_t operand = instruction[1] | (instruction[2] << 8);
+
+        // Landing in the middle of an instruction already decoded, or running into
+        // one, means the two paths disagree about where instructions start
+        if (next > a->size) return 1;
+        for (uint32_t i = address; i < next; i++)
+        {
+            if (a->bytes[i] & BYTE_CODE8080)
+            {
+                a->bytes[address] |= BYTE_CONFLICT8080;
+                a->conflicts++;
+                return 1;
+            }
+        }
+        a->bytes[address] |= BYTE_START8080;
+        for (uint32_t i = address; i < next; i++) a->bytes[i] |= BYTE_CODE8080;
+        a->instructions++;
+
+        int ok = 1;
+        switch (op->kind)
+        {
+            case OP_JMP: ok = addXref8080(w, address, operand, XREF_JUMP8080); queue8080(w, operand); return ok;
+            case OP_JCC: ok = addXref8080(w, address, operand, XREF_BRANCH8080); queue8080(w, operand); break;
+            case OP_CALL: case OP_CCC: ok = addXref8080(w, address, operand, XREF_CALL8080); queue8080(w, operand); break;
+            case OP_RST: ok = addXref8080(w, address, op->dst << 3, XREF_RST8080); queue8080(w, op->dst << 3); break;
+            case OP_LDA: case OP_LHLD: ok = addXref8080(w, address, operand, XREF_READ8080); break;
+            case OP_STA: case OP_SHLD: ok = addXref8080(w, address, operand, XREF_WRITE8080); break;
+            // LXI SP sets up a stack rather than pointing at data
+            case OP_LXI: if (op->dst != 3) ok = addXref8080(w, address, operand, XREF_POINTER8080); break;
+            // Computed targets are not followed
+            case OP_RET: case OP_PCHL: return 1;
+            default: break;
+        }
+        if (!ok) return 0;
+        address = next;
+    }
+    return 1;
+}
+
+int analyse8080(Analysis8080 *a, const uint8_t *image, uint32_t size, const uint16_t *entries, int entryCount)
+{
+    Walk8080 w = { a, NULL, NULL, 0, 0 };
+
+    memset(a, 0, sizeof(*a));
+    a->size = size;
+    a->image = calloc(size + 3, 1);
+    a->bytes = calloc(size + 1, 1);
+    a->first = calloc(0x10001, sizeof(uint32_t));
+    w.worklist = malloc((size + 1) * sizeof(uint32_t));
+    w.queued = calloc(size + 1, 1);
+    if (a->image == NULL || a->bytes == NULL || a->first == NULL || w.worklist == NULL || w.queued == NULL)
+    {
+        free(w.worklist);
+        free(w.queued);
+        freeAnalysis8080(a);
+        return 0;
+    }
+    memcpy(a->image, image, size);
+
+    // Entry points are traced one at a time in the order given, so the earlier
+    // ones decide where instructions start when paths disagree
+    for (int i = 0; i < entryCount; i++)
+    {
+        if (entries[i] >= size) continue;
+        a->bytes[entries[i]] |= BYTE_ENTRY8080;
+        if ((a->bytes[entries[i]] & BYTE_CODE8080) && !(a->bytes[entries[i]] & BYTE_START8080))
+        {
+            a->bytes[entries[i]] |= BYTE_CONFLICT8080;
+            a->conflicts++;
+            continue;
+        }
+        queue8080(&w, entries[i]);
+        while (w.pending > 0)
+        {
+            if (!trace8080(&w, w.worklist[--w.pending]))
+            {
+                free(w.worklist);
+                free(w.queued);
+                freeAnalysis8080(a);
+                return 0;
+            }
+        }
+    }
+    free(w.worklist);
+    free(w.queued);
+
+    // Two stable counting sorts, by referring address and then by target, leave
+    // first[] as the start of each target's run with its references in address order
+    Xref8080 *sorted = malloc((a->xrefCount + 1) * sizeof(Xref8080));
+    if (sorted == NULL)
+    {
+        freeAnalysis8080(a);
+        return 0;
+    }
+    for (int pass = 0; pass < 2; pass++)
+    {
+        memset(a->first, 0, 0x10001 * sizeof(uint32_t));
+        for (int i = 0; i < a->xrefCount; i++) a->first[(pass ? a->xrefs[i].to : a->xrefs[i].from) + 1]++;
+        for (int address = 0; address < 0x10000; address++) a->first[address + 1] += a->first[address];
+        for (int i = 0; i < a->xrefCount; i++) sorted[a->first[pass ? a->xrefs[i].to : a->xrefs[i].from]++] = a->xrefs[i];
+
+        Xref8080 *swap = a->xrefs;
+        a->xrefs = sorted;
+        sorted = swap;
+    }
+    free(sorted);
+    memmove(a->first + 1, a->first, 0x10000 * sizeof(uint32_t));
+    a->first[0] = 0;
+    return 1;
+}
+
+void freeAnalysis8080(Analysis8080 *a)
+{
+    free(a->image);
+    free(a->bytes);
+    free(a->xrefs);
+    free(a->first);
+    memset(a, 0, sizeof(*a));
+}
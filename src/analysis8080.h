@@ -0,0 +1,73 @@
+#ifndef ANALYSIS8080_H
+#define ANALYSIS8080_H
+
+#include <stdint.h>
+
+// Recursive-descent analysis of a ROM image. Starting from the entry points,
+// control flow is followed through JMP, CALL, Jcc, Ccc and RST with a worklist;
+// every byte reached as part of an instruction is code and everything else is
+// data. Computed jumps (PCHL, RET to a pushed address) are not followed, so code
+// only reached that way needs extra entry points. Every reference an instruction
+// makes to an address, as a branch target or as a memory operand, goes into a
+// cross-reference index sorted by target, so looking up who refers to an address
+// is a single array access.
+
+// Per-byte classification
+#define BYTE_CODE8080 0x01          // Part of an instruction
+#define BYTE_START8080 0x02         // First byte of an instruction
+#define BYTE_LABEL8080 0x04         // Target of a jump
+#define BYTE_SUBROUTINE8080 0x08    // Target of a call or RST
+#define BYTE_DATA_LABEL8080 0x10    // Target of a memory operand
+#define BYTE_ENTRY8080 0x20         // One of the entry points
+#define BYTE_CONFLICT8080 0x40      // A branch lands inside another instruction
+
+enum
+{
+    XREF_CALL8080,      // CALL and Ccc
+    XREF_JUMP8080,      // JMP
+    XREF_BRANCH8080,    // Jcc
+    XREF_RST8080,       // RST
+    XREF_READ8080,      // LDA, LHLD
+    XREF_WRITE8080,     // STA, SHLD
+    XREF_POINTER8080,   // LXI: an address loaded into a register pair
+    XREF_TYPE_COUNT8080
+};
+
+typedef struct
+{
+    uint16_t from;      // Address of the referring instruction
+    uint16_t to;
+    uint8_t type;
+} Xref8080;
+
+typedef struct
+{
+    uint8_t *image;     // Copy of the image, with room for the operands of a last instruction
+    uint32_t size;
+    uint8_t *bytes;     // BYTE_* flags of every byte of the image
+
+    // References sorted by target; those to address are xrefs[first[address]] up
+    // to xrefs[first[address + 1]]
+    Xref8080 *xrefs;
+    int xrefCount;
+    uint32_t *first;
+
+    int instructions;
+    int conflicts;
+} Analysis8080;
+
+extern const char *const xrefTypes8080[XREF_TYPE_COUNT8080];
+
+// Analyse size bytes of image, loaded at address 0, from the given entry points.
+// Returns 0 if out of memory.
+int analyse8080(Analysis8080 *a, const uint8_t *image, uint32_t size, const uint16_t *entries, int entryCount);
+void freeAnalysis8080(Analysis8080 *a);
+
+// References to address; *refs points at the first of them
+static inline int xrefsTo8080(const Analysis8080 *a, uint16_t address, const Xref8080 **refs)
+{
+    *refs = &a->xrefs[a->first[address]];
+    return a->first[address + 1] - a->first[address];
+}
+
+#endif
@@ -0,0 +1,28 @@
+#include <stdio.h>
+
+#include "aot8080.h"
+
+
+int initAot8080(Machine8080 *m)
+{
+    if (m->romSize < aotSize8080 || checksumAot8080(m->memory, aotSize8080) != aotChecksum8080) return 0;
+    engines8080[ENGINE_AOT] = runAot8080;
+    return 1;
+}
+
+uint64_t runAot8080(Machine8080 *m, uint64_t budget)
+{
+    uint64_t start = m->cycles;
+    m->target = start + budget;
+
+    while (m->cycles < m->target)
+    {
+        AotBlock8080 block = m->pc < aotSize8080 ? aotBlocks8080[m->pc] : NULL;
+
+        // Addresses the recompiler never saw are interpreted one instruction at a
+        // time until execution reaches a compiled block again
+        if (block != NULL) block(m);
+        else emulateOp8080(m, m->pc);
+    }
+    return m->cycles - start;
+}
@@ -0,0 +1,56 @@
+#ifndef AOT8080_H
+#define AOT8080_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpu8080.h"
+
+// Ahead-of-time recompiled ROM code. The recompiler walks the ROM's control flow
+// and emits a C file with one function per discovered block; that file is linked
+// with aot8080.c, which runs the functions and falls back to the interpreter for
+// anything it does not cover (PCHL targets nobody jumps to directly, RAM code).
+
+typedef void (*AotBlock8080)(Machine8080 *m);
+
+// Defined by the generated file
+extern const AotBlock8080 aotBlocks8080[];      // Block function starting at each address, or NULL
+extern const uint32_t aotSize8080;              // Bytes of ROM the blocks were compiled from
+extern const uint64_t aotChecksum8080;          // FNV-1a hash of those bytes
+
+// Check the generated code matches the ROM loaded into m and make ENGINE_AOT available.
+// Blocks stop before the instruction that would start past m->target.
+int initAot8080(Machine8080 *m);
+uint64_t runAot8080(Machine8080 *m, uint64_t budget);
+
+// FNV-1a, shared by the recompiler and the runtime check
+static inline uint64_t checksumAot8080(const uint8_t *bytes, uint32_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint32_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// One recompiled instruction: every field is a constant, so the compiler can
+// specialise the shared handler body for this exact instruction
+#define AOT8080(address, name, length, states, taken, dst, src, b0, b1, b2) \
+    { \
+        static const Dispatch8080 e = { NULL, OP_##name, length, states, taken, dst, src }; \
+        static const uint8_t bytes[3] = { b0, b1, b2 }; \
+        if (m->cycles >= m->target) { m->pc = address; return; } \
+        m->pc = (address) + (length); \
+        m->cycles += states; \
+        m->instructions++; \
+        op_##name(m, bytes, &e); \
+    }
+
+// Continue straight into a known successor block; a sibling call, so chains of
+// blocks run without returning to the dispatch loop in runAot8080
+#define AOTCHAIN8080(target) \
+    if (m->pc == 0x##target) { aotBlock##target(m); return; }
+
+#endif
@@ -0,0 +1,279 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "audio8080.h"
+#include "schedule8080.h"
+
+// How one effect is synthesised: a square wave gliding from one pitch to another
+// with a sine warble on top, or low-passed noise, under an exponential decay
+typedef struct
+{
+    float seconds;
+    float from, to;             // Pitch in Hz at the start and the end
+    float warble, depth;        // Rate and depth of the pitch warble, in Hz
+    float noise;                // Low-pass coefficient of the noise, 0 for the square wave
+    float decay;                // Per second
+    int repeats;                // Plays in a loop until stopped
+} Effect8080;
+
+static const Effect8080 effects8080[SOUND_COUNT8080] =
+{
+    [SOUND_UFO8080] =           { 0.125f,  700,  700,  8, 200, 0,     0,   1 },
+    [SOUND_SHOT8080] =          { 0.35f,     0,    0,  0,   0, 0.3f,  8,   0 },
+    [SOUND_PLAYER_DIES8080] =   { 1.2f,      0,    0,  0,   0, 0.08f, 2.5f, 0 },
+    [SOUND_INVADER_DIES8080] =  { 0.3f,   1200,  200,  0,   0, 0,     4,   0 },
+    [SOUND_EXTRA_LIFE8080] =    { 1.0f,   1000, 1000, 10, 300, 0,     1,   0 },
+    [SOUND_FLEET1_8080] =       { 0.1f,    110,  110,  0,   0, 0,    20,   0 },
+    [SOUND_FLEET2_8080] =       { 0.1f,     98,   98,  0,   0, 0,    20,   0 },
+    [SOUND_FLEET3_8080] =       { 0.1f,     87,   87,  0,   0, 0,    20,   0 },
+    [SOUND_FLEET4_8080] =       { 0.1f,     82,   82,  0,   0, 0,    20,   0 },
+    [SOUND_UFO_HIT8080] =       { 1.0f,    900,  300, 12, 150, 0,     1.5f, 0 },
+};
+
+#define VOICE_GAIN8080 0.25f
+
+
+static float *synthesise8080(const Effect8080 *effect, uint32_t length)
+{
+    float *samples = malloc(length * sizeof(float));
+    uint32_t seed = 0x8080;
+    double phase = 0;
+    float noise = 0;
+
+    if (samples == NULL) return NULL;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        double t = (double) i / AUDIO_RATE8080;
+        float value;
+
+        if (effect->noise != 0)
+        {
+            seed = seed * 1664525 + 1013904223;
+            noise += effect->noise * ((float) (seed >> 8) / (1 << 23) - 1 - noise);
+            value = noise * 2;
+        }
+        else
+        {
+            double pitch = effect->from + (effect->to - effect->from) * t / effect->seconds;
+            pitch += effect->depth * sin(2 * M_PI * effect->warble * t);
+            phase += pitch / AUDIO_RATE8080;
+            value = phase - floor(phase) < 0.5 ? 1 : -1;
+        }
+        samples[i] = value * expf(-effect->decay * t);
+    }
+    return samples;
+}
+
+// Never blocks: a full ring loses the event
+static void pushEvent8080(Audio8080 *audio, uint64_t cycles, uint8_t type, uint8_t effect)
+{
+    unsigned head = atomic_load_explicit(&audio->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&audio->tail, memory_order_acquire);
+
+    if (head - tail == AUDIO_RING8080)
+    {
+        audio->dropped++;
+        return;
+    }
+    audio->events[head % AUDIO_RING8080] = (AudioEvent8080) { cycles, type, effect };
+    atomic_store_explicit(&audio->head, head + 1, memory_order_release);
+}
+
+static void soundPort8080(void *device, Machine8080 *m, uint8_t port, uint8_t value)
+{
+    Audio8080 *audio = device;
+    uint8_t *bits = &audio->bits[port == 5];
+    uint8_t rising = value & ~*bits;
+    uint8_t falling = *bits & ~value;
+
+    *bits = value;
+    if ((rising | falling) == 0) return;
+
+    if (port == 3)
+    {
+        // Bits 0-4 are the effects in the order of the enum
+        for (int bit = 0; bit < 5; bit++)
+        {
+            if (rising & (1 << bit)) pushEvent8080(audio, m->cycles, AUDIO_START8080, SOUND_UFO8080 + bit);
+        }
+        if (falling & 0x01) pushEvent8080(audio, m->cycles, AUDIO_STOP8080, SOUND_UFO8080);
+        if ((rising | falling) & 0x20) pushEvent8080(audio, m->cycles, AUDIO_AMPLIFIER8080, (value >> 5) & 1);
+    }
+    else
+    {
+        for (int bit = 0; bit < 5; bit++)
+        {
+            if (rising & (1 << bit)) pushEvent8080(audio, m->cycles, AUDIO_START8080, SOUND_FLEET1_8080 + bit);
+        }
+    }
+}
+
+static void addSamples8080(float *restrict mix, const float *restrict samples, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) mix[i] += samples[i] * VOICE_GAIN8080;
+}
+
+// Mix count samples, at most AUDIO_BLOCK8080, and write them out
+static void mixBlock8080(Audio8080 *audio, uint32_t count)
+{
+    float mix[AUDIO_BLOCK8080] = { 0 };
+    int16_t out[AUDIO_BLOCK8080];
+
+    for (int effect = 0; effect < SOUND_COUNT8080; effect++)
+    {
+        uint32_t done = 0;
+
+        while (audio->playing[effect] && done < count)
+        {
+            uint32_t left = audio->lengths[effect] - audio->position[effect];
+            uint32_t step = count - done < left ? count - done : left;
+
+            if (audio->amplifier) addSamples8080(mix + done, audio->samples[effect] + audio->position[effect], step);
+            done += step;
+            audio->position[effect] += step;
+            if (audio->position[effect] == audio->lengths[effect])
+            {
+                audio->position[effect] = 0;
+                audio->playing[effect] = effects8080[effect].repeats;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float value = mix[i] * 32767;
+        value = value > 32767 ? 32767 : value < -32768 ? -32768 : value;
+        out[i] = (int16_t) value;
+    }
+    fwrite(out, sizeof(int16_t), count, audio->file);
+    audio->rendered += count;
+}
+
+static void mixUntil8080(Audio8080 *audio, uint64_t cycles)
+{
+    uint64_t sample = cycles > audio->start ? (cycles - audio->start) * AUDIO_RATE8080 / CLOCK_HZ8080 : 0;
+
+    while (audio->rendered < sample)
+    {
+        uint64_t left = sample - audio->rendered;
+        mixBlock8080(audio, left < AUDIO_BLOCK8080 ? left : AUDIO_BLOCK8080);
+    }
+}
+
+static void *mixer8080(void *argument)
+{
+    Audio8080 *audio = argument;
+    const struct timespec wait = { 0, 1000000 };
+
+    for (;;)
+    {
+        unsigned tail = atomic_load_explicit(&audio->tail, memory_order_relaxed);
+        if (tail == atomic_load_explicit(&audio->head, memory_order_acquire))
+        {
+            nanosleep(&wait, NULL);
+            continue;
+        }
+
+        AudioEvent8080 event = audio->events[tail % AUDIO_RING8080];
+        atomic_store_explicit(&audio->tail, tail + 1, memory_order_release);
+
+        mixUntil8080(audio, event.cycles);
+        switch (event.type)
+        {
+            case AUDIO_START8080:
+                audio->playing[event.effect] = 1;
+                audio->position[event.effect] = 0;
+                break;
+            case AUDIO_STOP8080:
+                audio->playing[event.effect] = 0;
+                break;
+            case AUDIO_AMPLIFIER8080:
+                audio->amplifier = event.effect;
+                break;
+            case AUDIO_END8080:
+                return NULL;
+            default:
+                break;
+        }
+    }
+}
+
+// 16-bit mono PCM; the sizes are filled in when the file is closed
+static void writeWavHeader8080(FILE *file, uint32_t samples)
+{
+    uint32_t data = samples * 2;
+    uint32_t header[11] =
+    {
+        0x46464952, 36 + data, 0x45564157,                  // "RIFF", size, "WAVE"
+        0x20746D66, 16, 0x00010001, AUDIO_RATE8080,         // "fmt ", PCM, mono
+        AUDIO_RATE8080 * 2, 0x00100002,                     // Bytes per second, 2-byte frames of 16 bits
+        0x61746164, data                                    // "data"
+    };
+
+    fwrite(header, sizeof(header), 1, file);
+}
+
+// Let the mixer catch up with the machine, then come back a block later
+static void audioTime8080(void *device, Machine8080 *m, uint64_t when)
+{
+    pushEvent8080(device, when, AUDIO_TIME8080, 0);
+    scheduleEvent8080(m, when + AUDIO_TICK8080, audioTime8080, device);
+}
+
+int openAudio8080(Audio8080 *audio, const char *path, Machine8080 *m, IoBus8080 *bus)
+{
+    memset(audio, 0, sizeof(*audio));
+    for (int effect = 0; effect < SOUND_COUNT8080; effect++)
+    {
+        audio->lengths[effect] = effects8080[effect].seconds * AUDIO_RATE8080;
+        audio->samples[effect] = synthesise8080(&effects8080[effect], audio->lengths[effect]);
+        if (audio->samples[effect] == NULL) goto failed;
+    }
+
+    audio->file = fopen(path, "wb");
+    if (audio->file == NULL) goto failed;
+    writeWavHeader8080(audio->file, 0);
+
+    audio->start = m->cycles;
+    if (!scheduleEvent8080(m, m->cycles + AUDIO_TICK8080, audioTime8080, audio)) goto failed;
+    if (pthread_create(&audio->mixer, NULL, mixer8080, audio) != 0)
+    {
+        cancelEvents8080(m, audioTime8080, audio);
+        goto failed;
+    }
+    audio->bus = bus;
+    attachDevice8080(bus, 3, 1, NULL, soundPort8080, audio);
+    attachDevice8080(bus, 5, 1, NULL, soundPort8080, audio);
+    return 1;
+
+failed:
+    if (audio->file != NULL) fclose(audio->file);
+    for (int effect = 0; effect < SOUND_COUNT8080; effect++) free(audio->samples[effect]);
+    return 0;
+}
+
+void closeAudio8080(Audio8080 *audio, Machine8080 *m)
+{
+    const struct timespec wait = { 0, 1000000 };
+
+    // The end must get through, so wait for room if need be
+    uint64_t dropped = audio->dropped;
+    for (;;)
+    {
+        pushEvent8080(audio, m->cycles, AUDIO_END8080, 0);
+        if (audio->dropped == dropped) break;
+        audio->dropped = dropped;
+        nanosleep(&wait, NULL);
+    }
+    pthread_join(audio->mixer, NULL);
+
+    rewind(audio->file);
+    writeWavHeader8080(audio->file, audio->rendered);
+    fclose(audio->file);
+    for (int effect = 0; effect < SOUND_COUNT8080; effect++) free(audio->samples[effect]);
+    cancelEvents8080(m, audioTime8080, audio);
+    detachDevice8080(audio->bus, 3, 1);
+    detachDevice8080(audio->bus, 5, 1);
+}
@@ -0,0 +1,98 @@
+#ifndef AUDIO8080_H
+#define AUDIO8080_H
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "cpu8080.h"
+#include "io8080.h"
+
+// Space Invaders sound. The board plays its effects from bits of ports 3 and 5:
+//   OUT 3: 0 UFO (repeats while set), 1 shot, 2 player dies, 3 invader dies,
+//          4 extra life, 5 amplifier on
+//   OUT 5: 0-3 the four fleet steps, 4 UFO hit
+// The port handlers run on the emulator thread and turn bit edges into events
+// stamped with the machine's cycle count: a rising edge starts an effect, a
+// falling one stops the UFO. Events go through a single-producer single-consumer
+// ring to a mixer thread, so the emulator never waits on a lock; when the ring is
+// full the event is dropped and counted instead.
+//
+// The mixer turns cycle stamps into sample positions and mixes the effects, one
+// voice each, in blocks of AUDIO_BLOCK8080 float samples with plain loops the
+// compiler vectorises, then writes them as 16-bit mono to a WAV file. So that
+// silence gets mixed too, an event on the machine's scheduler stamps the time
+// into the ring every AUDIO_TICK8080 states, a block's worth of samples. The original
+// board's effects were analog circuits and samples of them are not shipped here,
+// so each effect is synthesised into a sample table once at startup.
+
+#define AUDIO_RATE8080 44100
+#define AUDIO_BLOCK8080 256
+#define AUDIO_RING8080 4096
+#define AUDIO_TICK8080 ((uint64_t) AUDIO_BLOCK8080 * CLOCK_HZ8080 / AUDIO_RATE8080)
+
+enum
+{
+    SOUND_UFO8080,
+    SOUND_SHOT8080,
+    SOUND_PLAYER_DIES8080,
+    SOUND_INVADER_DIES8080,
+    SOUND_EXTRA_LIFE8080,
+    SOUND_FLEET1_8080,
+    SOUND_FLEET2_8080,
+    SOUND_FLEET3_8080,
+    SOUND_FLEET4_8080,
+    SOUND_UFO_HIT8080,
+    SOUND_COUNT8080
+};
+
+enum
+{
+    AUDIO_START8080,        // Start an effect from its beginning
+    AUDIO_STOP8080,         // Stop a repeating effect
+    AUDIO_AMPLIFIER8080,    // Amplifier on (effect 1) or off (effect 0)
+    AUDIO_TIME8080,         // Nothing happened up to here: mix up to it
+    AUDIO_END8080           // Mix up to here and stop
+};
+
+typedef struct
+{
+    uint64_t cycles;
+    uint8_t type;
+    uint8_t effect;
+} AudioEvent8080;
+
+typedef struct
+{
+    // Producer side: the emulator thread
+    _Alignas(64) atomic_uint head;
+    uint8_t bits[2];            // Last values written to ports 3 and 5
+    uint64_t dropped;           // Events lost to a full ring
+
+    // Consumer side: the mixer thread
+    _Alignas(64) atomic_uint tail;
+    uint64_t start;             // Machine cycles at sample 0
+    uint64_t rendered;          // Samples written so far
+    int amplifier;
+    uint32_t position[SOUND_COUNT8080];
+    uint8_t playing[SOUND_COUNT8080];
+
+    _Alignas(64) AudioEvent8080 events[AUDIO_RING8080];
+
+    float *samples[SOUND_COUNT8080];
+    uint32_t lengths[SOUND_COUNT8080];
+    FILE *file;
+    IoBus8080 *bus;
+    pthread_t mixer;
+} Audio8080;
+
+// Synthesise the effects, open a WAV file at path, start the mixer, attach the
+// sound ports to the machine's bus and schedule the mixer's time events. Time
+// starts at the machine's current cycle count. Returns 0 if anything failed.
+int openAudio8080(Audio8080 *audio, const char *path, Machine8080 *m, IoBus8080 *bus);
+// Mix everything up to the machine's cycle count, stop the mixer, finish the file,
+// cancel the time events and hand the ports back to the bus
+void closeAudio8080(Audio8080 *audio, Machine8080 *m);
+
+#endif
@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "aot8080.h"
+#include "cpu8080.h"
+#include "lanes8080.h"
+#include "pool8080.h"
+#include "rom8080.h"
+
+// Usage: batch [-n instances] [-f frames] [-j threads] [-e engine] [-l lanes] rom
+//   Runs independent machines spread over all cores with the work-stealing pool
+//   -n: number of machines (default: 1000)
+//   -f: 60 Hz frames each machine runs (default: 600)
+//   -j: worker threads (default: one per online CPU)
+//   -e: execution engine, goto, table, blocks or aot (default: aot if the ROM
+//       matches the recompiled one, blocks otherwise)
+//   -l: step groups of 8, 16 or 32 machines in lockstep (lanes8080.c) instead of
+//       running each machine on its own with the engine
+// Prints the aggregate emulated frames per second, per-worker task and steal
+// counts, and how many distinct final machine states the batch produced.
+
+typedef struct
+{
+    const char *romPath;
+    int engine;
+    int frames;
+    int lanes;                  // Machines per lockstep group, 0 for none
+    int instances;
+    uint64_t *states;           // Final state hash of each machine
+    uint64_t *instructions;     // Instructions each machine executed
+    int failed;                 // Set by any worker that could not set up a machine
+    uint64_t vectorLanes;       // Lockstep lane-instructions run as vector code
+    uint64_t scalarLanes;       // ... and one lane at a time
+} Batch8080;
+
+
+static uint64_t hashMachine8080(Machine8080 *m)
+{
+    uint64_t hash = checksumAot8080(m->memory, MEMORY_SIZE8080);
+    hash ^= checksumAot8080(m->registers, sizeof(m->registers));
+    hash ^= ((uint64_t) getFlags8080(m) << 32) ^ ((uint64_t) m->SP << 16) ^ m->pc;
+    return hash;
+}
+
+static void runMachine8080(void *context, int task, int worker)
+{
+    Batch8080 *batch = context;
+    Machine8080 machine;
+    (void) worker;
+
+    if (!initMachine8080(&machine) || !loadRom8080(&machine, batch->romPath))
+    {
+        freeMachine8080(&machine);
+        __atomic_store_n(&batch->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    machine.engine = batch->engine;
+
+    for (int frame = 0; frame < batch->frames; frame++) runFrame8080(&machine, 0);
+
+    batch->states[task] = hashMachine8080(&machine);
+    batch->instructions[task] = machine.instructions;
+    freeMachine8080(&machine);
+}
+
+// Lockstep variant: each task is one group of lanes machines
+static void runGroup8080(void *context, int task, int worker)
+{
+    Batch8080 *batch = context;
+    Machine8080 machines[LANES_MAX8080];
+    Machine8080 *group[LANES_MAX8080];
+    Lanes8080 lanes;
+    int first = task * batch->lanes;
+    int count = batch->instances - first < batch->lanes ? batch->instances - first : batch->lanes;
+    (void) worker;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (!initMachine8080(&machines[i]) || !loadRom8080(&machines[i], batch->romPath))
+        {
+            for (int j = 0; j <= i; j++) freeMachine8080(&machines[j]);
+            __atomic_store_n(&batch->failed, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        group[i] = &machines[i];
+    }
+
+    loadLanes8080(&lanes, group, count);
+    for (int frame = 0; frame < batch->frames; frame++) runLanesFrame8080(&lanes);
+    storeLanes8080(&lanes);
+
+    for (int i = 0; i < count; i++)
+    {
+        batch->states[first + i] = hashMachine8080(&machines[i]);
+        batch->instructions[first + i] = machines[i].instructions;
+        freeMachine8080(&machines[i]);
+    }
+    __atomic_add_fetch(&batch->vectorLanes, lanes.vectorLanes, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&batch->scalarLanes, lanes.scalarLanes, __ATOMIC_RELAXED);
+}
+
+static int compareHashes(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv)
+{
+    Batch8080 batch = { NULL, -1, 600, 0, 0, NULL, NULL, 0, 0, 0 };
+    int instances = 1000;
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) instances = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) batch.frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) batch.lanes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+        {
+            i++;
+            if (strcmp(argv[i], "goto") == 0) batch.engine = ENGINE_GOTO;
+            else if (strcmp(argv[i], "table") == 0) batch.engine = ENGINE_TABLE;
+            else if (strcmp(argv[i], "blocks") == 0) batch.engine = ENGINE_BLOCKS;
+            else if (strcmp(argv[i], "aot") == 0) batch.engine = ENGINE_AOT;
+            else
+            {
+                printf("error: unknown engine %s\n", argv[i]);
+                exit(1);
+            }
+        }
+        else batch.romPath = argv[i];
+    }
+
+    if (batch.romPath == NULL || instances < 1 || threads < 1 || (batch.lanes != 0 && batch.lanes != 8 && batch.lanes != 16 && batch.lanes != 32)) {
+        printf("usage: %s [-n instances] [-f frames] [-j threads] [-e engine] [-l lanes] rom\n", argv[0]);
+        exit(1);
+    }
+
+    // Check the ROM once up front; this also registers the AOT engine if it matches
+    Machine8080 probe;
+    if (!initMachine8080(&probe) || !loadRom8080(&probe, batch.romPath))
+    {
+        printf("error: could not read file %s\n", batch.romPath);
+        exit(2);
+    }
+    initDispatch8080();
+    initLanes8080();
+    int aot = initAot8080(&probe);
+    freeMachine8080(&probe);
+
+    if (batch.engine < 0) batch.engine = aot ? ENGINE_AOT : ENGINE_BLOCKS;
+    if (engines8080[batch.engine] == NULL)
+    {
+        printf("error: engine not available for this rom\n");
+        exit(1);
+    }
+
+    batch.instances = instances;
+    batch.states = calloc(instances, sizeof(uint64_t));
+    batch.instructions = calloc(instances, sizeof(uint64_t));
+    PoolStats8080 *stats = calloc(threads, sizeof(PoolStats8080));
+
+    double start = now();
+    int tasks = batch.lanes ? (instances + batch.lanes - 1) / batch.lanes : instances;
+    if (!runPool8080(threads, tasks, batch.lanes ? runGroup8080 : runMachine8080, &batch, stats))
+    {
+        printf("error: could not start %d worker threads\n", threads);
+        exit(3);
+    }
+    double elapsed = now() - start;
+    if (batch.failed)
+    {
+        printf("error: could not set up a machine\n");
+        exit(2);
+    }
+
+    uint64_t instructions = 0;
+    for (int i = 0; i < instances; i++) instructions += batch.instructions[i];
+    qsort(batch.states, instances, sizeof(uint64_t), compareHashes);
+    int distinct = 1;
+    for (int i = 1; i < instances; i++) distinct += batch.states[i] != batch.states[i - 1];
+
+    double frames = (double) instances * batch.frames;
+    printf("%d machines x %d frames on %d threads in %.3f s\n", instances, batch.frames, threads, elapsed);
+    printf("%.0f emulated frames/s (%.1fx real time), %.1f emulated MHz, %.2f ns/instruction overall\n",
+           frames / elapsed, frames / elapsed / 60, frames * FRAME_CYCLES8080 / elapsed / 1e6, elapsed * 1e9 / instructions);
+    for (int w = 0; w < threads; w++)
+    {
+        printf("worker %2d: %llu tasks, %llu stolen\n", w, (unsigned long long) stats[w].tasks, (unsigned long long) stats[w].steals);
+    }
+    if (batch.lanes)
+    {
+        printf("lockstep groups of %d: %.1f%% of lane-instructions ran as vector code\n", batch.lanes,
+               100.0 * batch.vectorLanes / (batch.vectorLanes + batch.scalarLanes));
+    }
+    printf("%d distinct final states\n", distinct);
+
+    free(stats);
+    free(batch.instructions);
+    free(batch.states);
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../disasm8080.h"
+#include "../listing8080.h"
+#include "../opcodes8080.h"
+
+// Benchmark for batch disassembly. Lists a large pseudo-random image (every
+// opcode turns up, so every line shape is covered) three ways: with
+// disassembleOp8080, with snprintf formatting the same fields the batch listing
+// has, and with writeListing8080 on one thread and on every core. Throughput is
+// input megabytes per second. The batch output must match the snprintf listing
+// byte for byte, whatever the thread count.
+
+#define IMAGE_BYTES ((8 << 20) + 1)
+#define LEGACY_BYTES (4 << 20)
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// The listing format, one snprintf per field
+static size_t formatReference(const uint8_t *image, size_t size, char *out)
+{
+    char *p = out;
+    int wide = size > 0x10000;
+
+    for (size_t address = 0; address < size;)
+    {
+        const Opcode8080 *op = &opcodes8080[image[address]];
+        p += sprintf(p, wide ? "%08zX" : "%04zX", address);
+        if (address + op->length > size)
+        {
+            p += sprintf(p, "  DB ");
+            for (size_t i = address; i < size; i++) p += sprintf(p, "%s$%02X", i > address ? "," : "", image[i]);
+            p += sprintf(p, "\n");
+            break;
+        }
+        p += sprintf(p, "  ");
+        for (int i = 0; i < 3; i++)
+        {
+            if (i < op->length) p += sprintf(p, "%02X ", image[address + i]);
+            else p += sprintf(p, "   ");
+        }
+        p += sprintf(p, "   %s", op->mnemonic);
+        const char *separator = op->mnemonic[strlen(op->mnemonic) - 1] == ',' ? "" : " ";
+        if (op->length == 2) p += sprintf(p, "%s$%02X", separator, image[address + 1]);
+        if (op->length == 3) p += sprintf(p, "%s$%04X", separator, image[address + 1] | (image[address + 2] << 8));
+        p += sprintf(p, "\n");
+        address += op->length;
+    }
+    return p - out;
+}
+
+// Time one batch listing to /dev/null, then check one written to a temporary
+// file against the reference
+static int runBatch(const uint8_t *image, const char *reference, size_t referenceLength, int threads)
+{
+    FILE *null = fopen("/dev/null", "w");
+    FILE *file = tmpfile();
+    if (null == NULL || file == NULL) return 0;
+
+    double start = now();
+    int ok = writeListing8080(null, image, IMAGE_BYTES, threads);
+    fflush(null);
+    double elapsed = now() - start;
+    fclose(null);
+
+    ok = ok && writeListing8080(file, image, IMAGE_BYTES, threads);
+    fflush(file);
+
+    long length = ftell(file);
+    char *listing = malloc(length > 0 ? length : 1);
+    rewind(file);
+    ok = ok && listing != NULL && fread(listing, 1, length, file) == (size_t) length;
+    fclose(file);
+
+    int same = ok && (size_t) length == referenceLength && memcmp(listing, reference, length) == 0;
+    free(listing);
+    printf("batch, %2d thread%s   %8.1f MB/s   %s\n", threads, threads == 1 ? " " : "s", IMAGE_BYTES / elapsed / 1e6, same ? "match" : "MISMATCH");
+    return same;
+}
+
+int main(void)
+{
+    uint8_t *image = malloc(IMAGE_BYTES + 3);
+    char *reference = malloc((size_t) IMAGE_BYTES * LISTING_LINE_MAX8080);
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int failed = 0;
+
+    if (image == NULL || reference == NULL)
+    {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+
+    uint64_t seed = 0x8080;
+    for (size_t i = 0; i < IMAGE_BYTES; i++)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        image[i] = seed >> 56;
+    }
+    // End on a JMP with its operand cut off
+    image[IMAGE_BYTES - 1] = 0xC3;
+
+    // The printing disassembler goes to /dev/null on a smaller slice
+    fflush(stdout);
+    int saved = dup(1);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, 1);
+    double start = now();
+    for (int pc = 0; pc < LEGACY_BYTES;) pc += disassembleOp8080(image, pc);
+    fflush(stdout);
+    double elapsed = now() - start;
+    dup2(saved, 1);
+    close(null);
+    close(saved);
+    printf("%d MiB image, %d cores\n", IMAGE_BYTES >> 20, threads);
+    printf("disassembleOp8080      %8.1f MB/s\n", LEGACY_BYTES / elapsed / 1e6);
+
+    start = now();
+    size_t referenceLength = formatReference(image, IMAGE_BYTES, reference);
+    elapsed = now() - start;
+    printf("snprintf per field     %8.1f MB/s   (%.1f MB of text)\n", IMAGE_BYTES / elapsed / 1e6, referenceLength / 1e6);
+
+    failed |= !runBatch(image, reference, referenceLength, 1);
+    if (threads > 1) failed |= !runBatch(image, reference, referenceLength, threads);
+    // More chunks than workers, whatever the core count, to check the ordering
+    failed |= !runBatch(image, reference, referenceLength, 3);
+
+    free(image);
+    free(reference);
+    return failed;
+}
@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "../aot8080.h"
+#include "../block8080.h"
+#include "../cpu8080.h"
+#include "../rom8080.h"
+
+// Benchmark for the opcode dispatch engines. Runs the ROM headless through
+//   legacy: the switch plus mask-test chain emulateOp8080 used to decode with
+//   table:  the function-pointer dispatch table
+//   goto:   the computed-goto threaded loop
+//   blocks: the predecoded basic-block cache
+//   aot:    the ROM recompiled to C ahead of time (when built with WITH_AOT8080)
+// and reports host ns per emulated instruction for each. Every backend runs the
+// same number of frames with the mid-screen and end-of-frame interrupts, and
+// idle-loop skipping off so the figures count only executed states.
+
+#define FRAMES 2000
+#define REPETITIONS 5
+
+static Dispatch8080 legacyEntry(uint8_t op, int kind, int dst, int src)
+{
+    const Opcode8080 *info = &opcodes8080[op];
+    Dispatch8080 entry = { handlers8080[kind], kind, info->length, info->cycles, info->cyclesTaken, dst, src };
+    return entry;
+}
+
+// Decode in the same order the old emulateOp8080 did: a switch over the fixed
+// opcodes, then a chain of mask tests ending with MVI and MOV
+static Dispatch8080 legacyDecode8080(uint8_t op)
+{
+    switch (op)
+    {
+        case 0b00000000: return legacyEntry(op, OP_NOP, 0, 0);
+        case 0b01110110: return legacyEntry(op, OP_HLT, 0, 0);
+        case 0b11110011: return legacyEntry(op, OP_DI, 0, 0);
+        case 0b11111011: return legacyEntry(op, OP_EI, 0, 0);
+        case 0b11010011: return legacyEntry(op, OP_OUT, 0, 0);
+        case 0b11011011: return legacyEntry(op, OP_IN, 0, 0);
+        case 0b11111001: return legacyEntry(op, OP_SPHL, 0, 0);
+        case 0b11100011: return legacyEntry(op, OP_XTHL, 0, 0);
+        case 0b11101001: return legacyEntry(op, OP_PCHL, 0, 0);
+        case 0b11001001: return legacyEntry(op, OP_RET, 0, 0);
+        case 0b11001101: return legacyEntry(op, OP_CALL, 0, 0);
+        case 0b11000011: return legacyEntry(op, OP_JMP, 0, 0);
+        case 0b00110111: return legacyEntry(op, OP_STC, 0, 0);
+        case 0b00111111: return legacyEntry(op, OP_CMC, 0, 0);
+        case 0b00101111: return legacyEntry(op, OP_CMA, 0, 0);
+        case 0b00011111: return legacyEntry(op, OP_RAR, 0, 0);
+        case 0b00010111: return legacyEntry(op, OP_RAL, 0, 0);
+        case 0b00001111: return legacyEntry(op, OP_RRC, 0, 0);
+        case 0b00000111: return legacyEntry(op, OP_RLC, 0, 0);
+        case 0b11111110: return legacyEntry(op, OP_CPI, 0, 0);
+        case 0b11110110: return legacyEntry(op, OP_ORI, 0, 0);
+        case 0b11101110: return legacyEntry(op, OP_XRI, 0, 0);
+        case 0b11100110: return legacyEntry(op, OP_ANI, 0, 0);
+        case 0b00100111: return legacyEntry(op, OP_DAA, 0, 0);
+        case 0b11011110: return legacyEntry(op, OP_SBI, 0, 0);
+        case 0b11010110: return legacyEntry(op, OP_SUI, 0, 0);
+        case 0b11001110: return legacyEntry(op, OP_ACI, 0, 0);
+        case 0b11000110: return legacyEntry(op, OP_ADI, 0, 0);
+        case 0b11101011: return legacyEntry(op, OP_XCHG, 0, 0);
+        case 0b00100010: return legacyEntry(op, OP_SHLD, 0, 0);
+        case 0b00101010: return legacyEntry(op, OP_LHLD, 0, 0);
+        case 0b00110010: return legacyEntry(op, OP_STA, 0, 0);
+        case 0b00111010: return legacyEntry(op, OP_LDA, 0, 0);
+        case 0b00001000: return legacyEntry(op, OP_NOP, 0, 0);
+        default: break;
+    }
+
+    int rp = (op & 0b00110000) >> 4;
+    int ddd = (op & 0b00111000) >> 3;
+    int sss = op & 0b00000111;
+
+    if ((op & 0b11001111) == 0b11000001) return legacyEntry(op, rp == 3 ? OP_POP_PSW : OP_POP, rp, 0);
+    if ((op & 0b11001111) == 0b11000101) return legacyEntry(op, rp == 3 ? OP_PUSH_PSW : OP_PUSH, rp, 0);
+    if ((op & 0b11000111) == 0b11000111) return legacyEntry(op, OP_RST, ddd, 0);
+    if ((op & 0b11000111) == 0b11000000) return legacyEntry(op, OP_RCC, ddd, 0);
+    if ((op & 0b11000111) == 0b11000100) return legacyEntry(op, OP_CCC, ddd, 0);
+    if ((op & 0b11000111) == 0b11000010) return legacyEntry(op, OP_JCC, ddd, 0);
+    if ((op & 0b11111000) == 0b10111000) return legacyEntry(op, sss == 6 ? OP_CMP_M : OP_CMP, 0, sss);
+    if ((op & 0b11111000) == 0b10110000) return legacyEntry(op, sss == 6 ? OP_ORA_M : OP_ORA, 0, sss);
+    if ((op & 0b11111000) == 0b10101000) return legacyEntry(op, sss == 6 ? OP_XRA_M : OP_XRA, 0, sss);
+    if ((op & 0b11111000) == 0b10100000) return legacyEntry(op, sss == 6 ? OP_ANA_M : OP_ANA, 0, sss);
+    if ((op & 0b11001111) == 0b00001001) return legacyEntry(op, OP_DAD, rp, 0);
+    if ((op & 0b11001111) == 0b00001011) return legacyEntry(op, OP_DCX, rp, 0);
+    if ((op & 0b11001111) == 0b00000011) return legacyEntry(op, OP_INX, rp, 0);
+    if ((op & 0b11000111) == 0b00000101) return legacyEntry(op, ddd == 6 ? OP_DCR_M : OP_DCR, ddd, 0);
+    if ((op & 0b11000111) == 0b00000100) return legacyEntry(op, ddd == 6 ? OP_INR_M : OP_INR, ddd, 0);
+    if ((op & 0b11111000) == 0b10011000) return legacyEntry(op, sss == 6 ? OP_SBB_M : OP_SBB, 0, sss);
+    if ((op & 0b11111000) == 0b10010000) return legacyEntry(op, sss == 6 ? OP_SUB_M : OP_SUB, 0, sss);
+    if ((op & 0b11111000) == 0b10001000) return legacyEntry(op, sss == 6 ? OP_ADC_M : OP_ADC, 0, sss);
+    if ((op & 0b11111000) == 0b10000000) return legacyEntry(op, sss == 6 ? OP_ADD_M : OP_ADD, 0, sss);
+    if ((op & 0b11001111) == 0b00000010) return legacyEntry(op, OP_STAX, rp, 0);
+    if ((op & 0b11001111) == 0b00001010) return legacyEntry(op, OP_LDAX, rp, 0);
+    if ((op & 0b11001111) == 0b00000001) return legacyEntry(op, OP_LXI, rp, 0);
+    if ((op & 0b11000111) == 0b00000110) return legacyEntry(op, ddd == 6 ? OP_MVI_M : OP_MVI, ddd, 0);
+    if ((op & 0b11000000) == 0b01000000)
+    {
+        if ((op & 0b11111000) == 0b01110000) return legacyEntry(op, OP_MOV_MR, 0, sss);
+        if ((op & 0b11000111) == 0b01000110) return legacyEntry(op, OP_MOV_RM, ddd, 0);
+        return legacyEntry(op, OP_MOV, ddd, sss);
+    }
+
+    // Undocumented aliases the old decoder never reached
+    return dispatch8080[op];
+}
+
+static uint64_t runLegacy8080(Machine8080 *m, uint64_t budget)
+{
+    uint64_t start = m->cycles;
+
+    while (m->cycles < start + budget)
+    {
+        const uint8_t *instruction = &m->memory[m->pc];
+        Dispatch8080 entry = legacyDecode8080(*instruction);
+        m->pc += entry.length;
+        m->cycles += entry.cycles;
+        m->instructions++;
+        entry.handler(m, instruction, &entry);
+    }
+    return m->cycles - start;
+}
+
+// Same frame structure as runFrame8080, with the backend under test
+static void runFrames8080(Machine8080 *m, uint64_t (*run)(Machine8080 *, uint64_t), int frames)
+{
+    for (int i = 0; i < frames; i++)
+    {
+        run(m, FRAME_CYCLES8080 / 2);
+        interrupt8080(m, 1);
+        run(m, FRAME_CYCLES8080 * (i + 1) - m->cycles);
+        interrupt8080(m, 2);
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double measure(Machine8080 *m, const char *name, uint64_t (*run)(Machine8080 *, uint64_t))
+{
+    double best = 1e30;
+    uint64_t instructions = 0;
+
+    for (int i = 0; i < REPETITIONS; i++)
+    {
+        resetMachine8080(m);
+        double start = now();
+        runFrames8080(m, run, FRAMES);
+        double elapsed = now() - start;
+        if (elapsed < best) best = elapsed;
+        instructions = m->instructions;
+    }
+
+    double ns = best * 1e9 / instructions;
+    printf("%-8s %7.2f ns/instruction  %8.1f emulated MHz  (pc %04X, %llu instructions)\n",
+           name, ns, m->cycles / best / 1e6, m->pc, (unsigned long long) instructions);
+    return ns;
+}
+
+int main(int argc, char** argv)
+{
+    Machine8080 machine;
+    Machine8080 *m = &machine;
+
+    if (argc < 2) {
+        printf("usage: %s rom\n", argv[0]);
+        exit(1);
+    }
+    if (!initMachine8080(m) || !loadRom8080(m, argv[1]))
+    {
+        printf("error: could not read file %s\n", argv[1]);
+        exit(2);
+    }
+    m->idleSkip = 0;
+
+    initDispatch8080();
+
+    printf("%d frames, best of %d runs\n", FRAMES, REPETITIONS);
+    double legacy = measure(m, "legacy", runLegacy8080);
+    double table = measure(m, "table", runTable8080);
+    double threaded = measure(m, "goto", runGoto8080);
+    double blocks = measure(m, "blocks", runBlocks8080);
+    printf("speedup over legacy: table %.2fx, goto %.2fx, blocks %.2fx\n", legacy / table, legacy / threaded, legacy / blocks);
+#ifdef WITH_AOT8080
+    if (initAot8080(m))
+    {
+        double aot = measure(m, "aot", runAot8080);
+        printf("aot: %.2fx over legacy, %.2fx over blocks\n", legacy / aot, blocks / aot);
+    }
+#endif
+
+    return 0;
+}
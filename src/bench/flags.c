@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "../block8080.h"
+#include "../cpu8080.h"
+
+// Microbenchmark for flag evaluation. Built twice, as flags_lazy and (with
+// EAGER_FLAGS8080) flags_eager, and runs the same synthetic programs on both:
+//   alu:    long runs of ALU operations with one conditional jump per loop
+//   branch: every ALU operation followed by a conditional jump
+//   psw:    every ALU operation followed by PUSH PSW / POP PSW
+// Reports host ns per emulated instruction on the block engine.
+
+#define CYCLES 100000000
+#define REPETITIONS 5
+
+// Flag-setting operations the programs cycle through
+static const uint8_t alu8080[][2] = {
+    {0x80, 0}, {0x89, 0}, {0x92, 0}, {0x9B, 0}, {0xA4, 0}, {0xAD, 0}, {0xB0, 0}, {0xB9, 0},
+    {0x14, 0}, {0x1D, 0}, {0xC6, 3}, {0xD6, 1}, {0xFE, 7}, {0xE6, 0xF7}, {0xEE, 0x55}, {0xCE, 9},
+};
+#define ALU_OPS (sizeof(alu8080) / sizeof(alu8080[0]))
+
+enum { PROGRAM_ALU, PROGRAM_BRANCH, PROGRAM_PSW };
+
+static uint16_t emitByte8080(Machine8080 *m, uint16_t address, uint8_t byte)
+{
+    m->memory[address] = byte;
+    return address + 1;
+}
+
+// Write the program at 0x0000; it loops forever, counting down in C
+static void loadProgram8080(Machine8080 *m, int program)
+{
+    uint16_t address = 0;
+    address = emitByte8080(m, address, 0x31);              // LXI SP,2400
+    address = emitByte8080(m, address, 0x00);
+    address = emitByte8080(m, address, 0x24);
+    uint16_t loop = address;
+
+    for (int i = 0; i < 4; i++)
+    {
+        for (unsigned op = 0; op < ALU_OPS; op++)
+        {
+            address = emitByte8080(m, address, alu8080[op][0]);
+            if (opcodes8080[alu8080[op][0]].length == 2) address = emitByte8080(m, address, alu8080[op][1]);
+
+            if (program == PROGRAM_BRANCH)
+            {
+                // Jcc to the next instruction, cycling through the conditions
+                uint16_t next = address + 3;
+                address = emitByte8080(m, address, 0xC2 | ((op & 7) << 3));
+                address = emitByte8080(m, address, next & 0xFF);
+                address = emitByte8080(m, address, next >> 8);
+            }
+            else if (program == PROGRAM_PSW)
+            {
+                address = emitByte8080(m, address, 0xF5);  // PUSH PSW
+                address = emitByte8080(m, address, 0xF1);  // POP PSW
+            }
+        }
+    }
+
+    address = emitByte8080(m, address, 0x0D);              // DCR C
+    address = emitByte8080(m, address, 0xC2);              // JNZ loop
+    address = emitByte8080(m, address, loop & 0xFF);
+    address = emitByte8080(m, address, loop >> 8);
+    address = emitByte8080(m, address, 0xC3);              // JMP loop
+    address = emitByte8080(m, address, loop & 0xFF);
+    emitByte8080(m, address, loop >> 8);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void measure(Machine8080 *m, const char *name, int program)
+{
+    double best = 1e30;
+    uint64_t instructions = 0;
+
+    for (int i = 0; i < REPETITIONS; i++)
+    {
+        resetMachine8080(m);
+        loadProgram8080(m, program);
+        double start = now();
+        runBlocks8080(m, CYCLES);
+        double elapsed = now() - start;
+        if (elapsed < best) best = elapsed;
+        instructions = m->instructions;
+    }
+
+    printf("%-8s %7.2f ns/instruction  %8.1f emulated MHz  (flags %02X, %llu instructions)\n",
+           name, best * 1e9 / instructions, CYCLES / best / 1e6, getFlags8080(m), (unsigned long long) instructions);
+}
+
+int main(void)
+{
+    Machine8080 machine;
+    Machine8080 *m = &machine;
+
+    if (!initMachine8080(m))
+    {
+        printf("error: could not allocate memory\n");
+        exit(2);
+    }
+    initDispatch8080();
+
+#ifdef EAGER_FLAGS8080
+    printf("eager flags, %d states, best of %d runs\n", CYCLES, REPETITIONS);
+#else
+    printf("lazy flags, %d states, best of %d runs\n", CYCLES, REPETITIONS);
+#endif
+    measure(m, "alu", PROGRAM_ALU);
+    measure(m, "branch", PROGRAM_BRANCH);
+    measure(m, "psw", PROGRAM_PSW);
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "../cpu8080.h"
+#include "../frame8080.h"
+#include "../rom8080.h"
+#include "../video8080.h"
+
+// Benchmark for the frame handoff. Runs the ROM flat out for a few thousand
+// frames and presents them as a Y4M video to /dev/null four ways:
+//   none:      no video at all, the emulator on its own
+//   inline:    the emulator thread converts and writes every frame itself
+//   exchange:  frames go through the triple buffer to a presenter thread
+//              writing 60 frames a second
+//   unpaced:   the same with a presenter that never sleeps
+// and reports emulated frames per second, what publishing a frame costs the
+// emulator thread, and the dropped and duplicated frame counts. Idle-loop
+// skipping is off, so every frame costs the full emulation.
+
+#define FRAMES 6000
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+enum { MODE_NONE, MODE_INLINE, MODE_EXCHANGE, MODE_UNPACED, MODE_COUNT };
+static const char *modeNames[MODE_COUNT] = { "none", "inline", "exchange", "unpaced" };
+
+int main(int argc, char** argv)
+{
+    static Machine8080 machine;
+    static FrameExchange8080 exchange;
+    static Presenter8080 presenter;
+    Machine8080 *m = &machine;
+    Video8080 video;
+
+    if (argc < 2)
+    {
+        printf("usage: %s rom\n", argv[0]);
+        exit(1);
+    }
+    if (!initMachine8080(m) || !loadRom8080(m, argv[1]))
+    {
+        printf("error: could not read file %s\n", argv[1]);
+        exit(2);
+    }
+    m->idleSkip = 0;
+    initDispatch8080();
+
+    printf("%d frames\n", FRAMES);
+    for (int mode = 0; mode < MODE_COUNT; mode++)
+    {
+        FILE *null = fopen("/dev/null", "wb");
+        double publishing = 0;
+
+        resetMachine8080(m);
+        if (null == NULL || !initVideo8080(&video, PIXELS_GRAY8080) || !initExchange8080(&exchange, PIXELS_GRAY8080))
+        {
+            printf("error: out of memory\n");
+            exit(2);
+        }
+        if (mode >= MODE_EXCHANGE && !startPresenter8080(&presenter, &exchange, "/dev/null", mode == MODE_UNPACED ? 1000000000 : 60))
+        {
+            printf("error: could not start the presenter\n");
+            exit(2);
+        }
+
+        double start = now();
+        for (int frame = 0; frame < FRAMES; frame++)
+        {
+            runFrame8080(m, 0);
+
+            double before = now();
+            if (mode == MODE_INLINE)
+            {
+                convertFrame8080(&video, m);
+                fputs("FRAME\n", null);
+                fwrite(video.pixels, SCREEN_WIDTH8080, SCREEN_HEIGHT8080, null);
+            }
+            else if (mode >= MODE_EXCHANGE) publishFrame8080(&exchange, m, frame);
+            publishing += now() - before;
+        }
+        double elapsed = now() - start;
+
+        if (mode >= MODE_EXCHANGE) stopPresenter8080(&presenter);
+        printf("%-9s %9.0f frames/s  %7.0f ns/frame on the emulator thread", modeNames[mode], FRAMES / elapsed, publishing * 1e9 / FRAMES);
+        if (mode >= MODE_EXCHANGE)
+        {
+            printf("  %llu presented, %llu dropped, %llu duplicated", (unsigned long long) exchange.presented,
+                   (unsigned long long) exchange.dropped, (unsigned long long) exchange.duplicated);
+        }
+        printf("\n");
+
+        freeExchange8080(&exchange);
+        freeVideo8080(&video);
+        fclose(null);
+    }
+
+    freeMachine8080(m);
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "../cpu8080.h"
+#include "../replay8080.h"
+#include "../rom8080.h"
+#include "../runahead8080.h"
+#include "../schedule8080.h"
+#include "../state8080.h"
+
+// Benchmark for run-ahead. Replays an input log for a minute of frames, running
+// 0 to 4 frames ahead after each one, and reports for each distance:
+//   - what a frame costs, snapshot and restore included, and that against the
+//     frame without run-ahead
+//   - how many frames a second the host could emulate that way
+//   - the input latency it saves, and how often the frame shown ahead matched
+//     the screen of the real frame it predicted. It misses when the input
+//     changed in between.
+// It also checks that running ahead leaves the real frames exactly as they were,
+// device events included: a device event scheduled every DEVICE_PERIOD states
+// must fire at the same times with run-ahead as without, and be off the queue
+// once cancelled.
+//
+// Usage: runahead rom log
+
+#define FRAMES 3600
+#define MAX_AHEAD 4
+#define FRAME_MS (1000.0 / 60)
+#define DEVICE_PERIOD 10007     // Prime, so it falls all over the frame
+
+// A device that notes every time its event fires
+typedef struct
+{
+    uint64_t fired;
+    uint64_t times;             // Hash of the cycle counts it fired at
+} Ticker8080;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t hashBytes(const uint8_t *bytes, size_t size)
+{
+    uint64_t hash = 1469598103934665603ULL;
+
+    for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    return hash;
+}
+
+static void tick8080(void *device, Machine8080 *m, uint64_t when)
+{
+    Ticker8080 *ticker = device;
+
+    ticker->fired++;
+    ticker->times = (ticker->times ^ when) * 1099511628211ULL;
+    scheduleEvent8080(m, when + DEVICE_PERIOD, tick8080, ticker);
+}
+
+static int hasEvents8080(Machine8080 *m, EventHandler8080 handler)
+{
+    for (int i = 0; i < m->eventCount; i++)
+    {
+        if (m->events[i].handler == handler) return 1;
+    }
+    return 0;
+}
+
+static uint64_t hashState(Machine8080 *m)
+{
+    State8080 s;
+
+    saveState8080(m, &s);
+    return hashBytes((const uint8_t *) &s, sizeof(s));
+}
+
+int main(int argc, char** argv)
+{
+    static Machine8080 machine;
+    static RunAhead8080 runAhead;
+    static uint64_t screens[FRAMES];            // Screen after each real frame
+    static uint64_t shown[FRAMES];              // Screen presented after each real frame
+    Machine8080 *m = &machine;
+    Replay8080 replay;
+    uint64_t finalState = 0;
+    Ticker8080 ticker, finalTicker = { 0, 0 };
+    double baseline = 0;
+    int failed = 0;
+
+    if (argc < 3)
+    {
+        printf("usage: %s rom log\n", argv[0]);
+        exit(1);
+    }
+    if (!initMachine8080(m) || !loadRom8080(m, argv[1]))
+    {
+        printf("error: could not read file %s\n", argv[1]);
+        exit(2);
+    }
+    initDispatch8080();
+
+    printf("%d frames of %s on the block cache\n", FRAMES, argv[2]);
+    for (int ahead = 0; ahead <= MAX_AHEAD; ahead++)
+    {
+        uint64_t dirty[VRAM_DIRTY_WORDS8080];
+        double elapsed = 0;
+        int matches = 0;
+
+        if (!openReplay8080(&replay, argv[2], m) || !seekReplay8080(&replay, m, 0))
+        {
+            printf("error: could not read input log %s\n", argv[2]);
+            exit(2);
+        }
+        initRunAhead8080(&runAhead, ahead);
+        ticker = (Ticker8080) { 0, 1469598103934665603ULL };
+        scheduleEvent8080(m, m->cycles + DEVICE_PERIOD, tick8080, &ticker);
+
+        for (int frame = 0; frame < FRAMES; frame++)
+        {
+            double start = now();
+            applyReplay8080(&replay, m, frame);
+            runFrame8080(m, 0);
+            if (ahead > 0) runAhead8080(&runAhead, m);
+            elapsed += now() - start;
+
+            // What a presenter would show, then hand the dirty lines over as it would
+            shown[frame] = hashBytes(m->memory + VRAM_START8080, VRAM_SIZE8080);
+            takeVramDirty8080(m, dirty);
+
+            start = now();
+            if (ahead > 0) restoreAhead8080(&runAhead, m);
+            elapsed += now() - start;
+            if (ahead == 0) screens[frame] = shown[frame];
+        }
+        for (int frame = 0; frame + ahead < FRAMES; frame++) matches += shown[frame] == screens[frame + ahead];
+
+        uint64_t state = hashState(m);
+        cancelEvents8080(m, tick8080, &ticker);
+        if (ahead == 0)
+        {
+            finalState = state;
+            finalTicker = ticker;
+            baseline = elapsed;
+        }
+        int same = state == finalState && replay.desyncs == 0 && ticker.fired == finalTicker.fired &&
+                   ticker.times == finalTicker.times && !hasEvents8080(m, tick8080);
+        failed |= !same;
+        printf("ahead %d: %7.1f us/frame (%4.2fx)  %6.0f frames/s  saves %5.1f ms  %5.1f%% of frames shown ahead matched  %s\n",
+               ahead, elapsed * 1e6 / FRAMES, elapsed / baseline, FRAMES / elapsed, ahead * FRAME_MS,
+               100.0 * matches / (FRAMES - ahead), same ? "real frames unchanged" : "REAL FRAMES CHANGED");
+        closeReplay8080(&replay);
+    }
+
+    freeMachine8080(m);
+    return failed;
+}
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "../cpu8080.h"
+#include "../rewind8080.h"
+#include "../rom8080.h"
+#include "../state8080.h"
+
+// Benchmark for save states and the rewind buffer. Measures snapshot and restore
+// latency, then runs five minutes of frames with a rewind snapshot after each
+// one and reports the encoded bytes per frame and how much history the buffer
+// holds. Finally it rewinds to several points, checks the restored state against
+// a hash taken when that frame was live, and replays forward from there to check
+// the machine carries on exactly as it did the first time.
+
+#define WARMUP_FRAMES 600
+#define HISTORY_FRAMES (5 * 60 * 60)
+#define REWIND_BYTES (4 << 20)
+#define KEYFRAME_INTERVAL 20
+#define REPETITIONS 100000
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t hashState(Machine8080 *m)
+{
+    State8080 s;
+    uint64_t hash = 1469598103934665603ULL;
+
+    saveState8080(m, &s);
+    for (size_t i = 0; i < sizeof(s); i++) hash = (hash ^ ((uint8_t *) &s)[i]) * 1099511628211ULL;
+    return hash;
+}
+
+int main(int argc, char** argv)
+{
+    Machine8080 machine;
+    Machine8080 *m = &machine;
+    static State8080 state;
+    static uint64_t hashes[HISTORY_FRAMES];
+    Rewind8080 history;
+    int failed = 0;
+
+    if (argc < 2) {
+        printf("usage: %s rom\n", argv[0]);
+        exit(1);
+    }
+    if (!initMachine8080(m) || !loadRom8080(m, argv[1]) || !initRewind8080(&history, REWIND_BYTES, KEYFRAME_INTERVAL))
+    {
+        printf("error: could not read file %s\n", argv[1]);
+        exit(2);
+    }
+
+    initDispatch8080();
+    for (int i = 0; i < WARMUP_FRAMES; i++) runFrame8080(m, 0);
+
+    double start = now();
+    for (int i = 0; i < REPETITIONS; i++)
+    {
+        saveState8080(m, &state);
+        __asm__ volatile("" : : "r"(&state) : "memory");
+    }
+    double save = (now() - start) * 1e9 / REPETITIONS;
+    start = now();
+    for (int i = 0; i < REPETITIONS; i++)
+    {
+        loadState8080(m, &state);
+        __asm__ volatile("" : : "r"(m) : "memory");
+    }
+    double load = (now() - start) * 1e9 / REPETITIONS;
+    printf("snapshot %zu bytes: save %.0f ns, load %.0f ns\n", sizeof(State8080), save, load);
+
+    double pushTime = 0;
+    for (int i = 0; i < HISTORY_FRAMES; i++)
+    {
+        runFrame8080(m, 0);
+        hashes[i] = hashState(m);
+        start = now();
+        pushRewind8080(&history, m);
+        pushTime += now() - start;
+    }
+    uint64_t deltas = history.pushes - history.keyframes;
+    printf("rewind: %d frames, %.0f bytes/frame (keyframe every %d), push %.0f ns/frame\n",
+           HISTORY_FRAMES, (double) history.pushedBytes / history.pushes, KEYFRAME_INTERVAL, pushTime * 1e9 / HISTORY_FRAMES);
+    printf("rewind: %d KiB holds the last %d frames (%.1f minutes) in %zu bytes; %llu keyframes, %llu deltas\n",
+           REWIND_BYTES >> 10, history.count, history.count / 3600.0, history.used,
+           (unsigned long long) history.keyframes, (unsigned long long) deltas);
+
+    // Step back in stages; the newest snapshot is frame HISTORY_FRAMES - 1
+    int frame = HISTORY_FRAMES - 1;
+    int stages[] = { 0, 1, 19, 20, 21, 1000, history.count };
+    for (int i = 0; i < (int) (sizeof(stages) / sizeof(stages[0])); i++)
+    {
+        start = now();
+        int taken = rewindMachine8080(&history, m, stages[i]);
+        double elapsed = now() - start;
+        frame -= taken;
+        int same = hashState(m) == hashes[frame];
+        failed |= !same;
+        printf("rewind %4d frames to frame %5d in %6.0f ns: %s\n", taken, frame, elapsed * 1e9, same ? "match" : "MISMATCH");
+    }
+
+    // The restored machine replays the same frames again
+    for (int i = frame + 1; i < HISTORY_FRAMES; i++)
+    {
+        runFrame8080(m, 0);
+        if (hashState(m) != hashes[i])
+        {
+            printf("replay after rewind diverges at frame %d\n", i);
+            failed = 1;
+            break;
+        }
+    }
+    if (!failed) printf("replay from frame %d to %d matches\n", frame, HISTORY_FRAMES - 1);
+
+    freeRewind8080(&history);
+    freeMachine8080(m);
+    return failed;
+}
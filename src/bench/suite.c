@@ -0,0 +1,462 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "../aot8080.h"
+#include "../cpu8080.h"
+#include "../rom8080.h"
+
+// CPU benchmark suite. Runs small synthetic programs, each stressing one kind of
+// instruction, on every interpreter engine, then frames of the Invaders ROM on
+// every engine including the recompiled one. Each run is repeated; the median is
+// reported as emulated MHz and host ns per instruction, along with the fastest
+// run and the spread across repetitions as a coefficient of variation. Idle-loop
+// skipping is off, so every state counted is one the engine actually executed.
+//
+// Usage: suite [-n repetitions] [-o results] [-b baseline [-t percent]] [-s results] rom
+//   -o: write the results as tab-separated values
+//   -s: print the speedup of each workload over results written by -o from
+//       another build, such as the plain build against the release one, and
+//       exit with 1 if the geometric mean speedup is below 1
+//   -b: compare against results written earlier by -o and exit with 1 if the
+//       fastest run of any workload is more than -t percent (default 50) slower,
+//       or if any workload executed a different number of instructions.
+//       The fastest run is the steadiest figure on a busy host; the tolerance is
+//       wide because some workloads move by a third or more between processes.
+// Baselines only mean something on the host that recorded them; refresh the
+// stored one with make bench_baseline after changing machines.
+
+#define SYNTHETIC_CYCLES 40000000
+#define FRAMES 2000
+#define DEFAULT_REPETITIONS 9
+#define MAX_REPETITIONS 64
+#define MAX_RESULTS 64
+
+typedef struct
+{
+    const char *name;
+    const uint8_t *code;
+    size_t size;
+} Program8080;
+
+typedef struct
+{
+    char workload[32];
+    char engine[16];
+    int repetitions;
+    uint64_t instructions;      // Per repetition
+    double mhz;
+    double ns;                  // Median host ns per instruction
+    double best;                // Fastest run
+    double spread;              // Standard deviation of ns per instruction, percent of the mean
+} Result8080;
+
+// Synthetic programs, loaded at 0x0000 with no ROM and run with interrupts off.
+// Each is one endless loop.
+
+// Register moves and immediates
+static const uint8_t movMvi8080[] =
+{
+    0xF3,               // 0000 DI
+    0x06, 0x01,         // 0001 MVI B,01
+    0x0E, 0x02,         // 0003 MVI C,02
+    0x50,               // 0005 MOV D,B
+    0x59,               // 0006 MOV E,C
+    0x62,               // 0007 MOV H,D
+    0x6B,               // 0008 MOV L,E
+    0x7C,               // 0009 MOV A,H
+    0x47,               // 000A MOV B,A
+    0x4D,               // 000B MOV C,L
+    0x16, 0x03,         // 000C MVI D,03
+    0x1E, 0x04,         // 000E MVI E,04
+    0x7A,               // 0010 MOV A,D
+    0xC3, 0x01, 0x00,   // 0011 JMP 0001
+};
+
+// A chain of ALU operations, each depending on the flags or A of the one before
+static const uint8_t alu8080[] =
+{
+    0xF3,               // 0000 DI
+    0x3E, 0x5A,         // 0001 MVI A,5A
+    0x06, 0x13,         // 0003 MVI B,13
+    0x0E, 0x27,         // 0005 MVI C,27
+    0x80,               // 0007 ADD B
+    0x89,               // 0008 ADC C
+    0x92,               // 0009 SUB D
+    0x9B,               // 000A SBB E
+    0xA0,               // 000B ANA B
+    0xA9,               // 000C XRA C
+    0xB4,               // 000D ORA H
+    0xBD,               // 000E CMP L
+    0xC6, 0x11,         // 000F ADI 11
+    0xD6, 0x07,         // 0011 SUI 07
+    0xE6, 0xF3,         // 0013 ANI F3
+    0xF6, 0x0C,         // 0015 ORI 0C
+    0xEE, 0x55,         // 0017 XRI 55
+    0xFE, 0x80,         // 0019 CPI 80
+    0x04,               // 001B INR B
+    0x0D,               // 001C DCR C
+    0x07,               // 001D RLC
+    0x1F,               // 001E RAR
+    0x27,               // 001F DAA
+    0xC3, 0x07, 0x00,   // 0020 JMP 0007
+};
+
+// Recursion 16 calls deep, unwinding through conditional and plain returns
+static const uint8_t callRet8080[] =
+{
+    0xF3,               // 0000 DI
+    0x31, 0x00, 0xF0,   // 0001 LXI SP,F000
+    0x3E, 0x10,         // 0004 MVI A,10
+    0xCD, 0x0C, 0x00,   // 0006 CALL 000C
+    0xC3, 0x04, 0x00,   // 0009 JMP 0004
+    0x3D,               // 000C DCR A
+    0xC8,               // 000D RZ
+    0xCD, 0x0C, 0x00,   // 000E CALL 000C
+    0xC9,               // 0011 RET
+};
+
+// Stack traffic: every pair pushed, the top swapped with HL, and popped again
+static const uint8_t pushPop8080[] =
+{
+    0xF3,               // 0000 DI
+    0x31, 0x00, 0xF0,   // 0001 LXI SP,F000
+    0xC5,               // 0004 PUSH B
+    0xD5,               // 0005 PUSH D
+    0xE5,               // 0006 PUSH H
+    0xF5,               // 0007 PUSH PSW
+    0xE3,               // 0008 XTHL
+    0xF1,               // 0009 POP PSW
+    0xE1,               // 000A POP H
+    0xD1,               // 000B POP D
+    0xC1,               // 000C POP B
+    0x03,               // 000D INX B
+    0x13,               // 000E INX D
+    0xC3, 0x04, 0x00,   // 000F JMP 0004
+};
+
+// Copy 4 KiB from 8000 to A000 a byte at a time, over and over
+static const uint8_t memSweep8080[] =
+{
+    0xF3,               // 0000 DI
+    0x01, 0x00, 0x80,   // 0001 LXI B,8000
+    0x11, 0x00, 0xA0,   // 0004 LXI D,A000
+    0x0A,               // 0007 LDAX B
+    0x3C,               // 0008 INR A
+    0x12,               // 0009 STAX D
+    0x03,               // 000A INX B
+    0x13,               // 000B INX D
+    0x78,               // 000C MOV A,B
+    0xFE, 0x90,         // 000D CPI 90
+    0xC2, 0x07, 0x00,   // 000F JNZ 0007
+    0xC3, 0x01, 0x00,   // 0012 JMP 0001
+};
+
+static const Program8080 programs8080[] =
+{
+    { "mov_mvi", movMvi8080, sizeof(movMvi8080) },
+    { "alu", alu8080, sizeof(alu8080) },
+    { "call_ret", callRet8080, sizeof(callRet8080) },
+    { "push_pop", pushPop8080, sizeof(pushPop8080) },
+    { "mem_sweep", memSweep8080, sizeof(memSweep8080) },
+};
+
+static const char *const engineNames8080[ENGINE_COUNT] = { "goto", "table", "blocks", "aot" };
+
+static Result8080 results[MAX_RESULTS];
+static int resultCount = 0;
+
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+// Summarise the repetitions of one workload on one engine
+static void addResult(const char *workload, int engine, const double *ns, const double *mhz, int repetitions, uint64_t instructions)
+{
+    Result8080 *r = &results[resultCount++];
+    double sorted[MAX_REPETITIONS];
+    double mean = 0, variance = 0;
+
+    for (int i = 0; i < repetitions; i++) mean += ns[i];
+    mean /= repetitions;
+    for (int i = 0; i < repetitions; i++) variance += (ns[i] - mean) * (ns[i] - mean);
+    variance /= repetitions > 1 ? repetitions - 1 : 1;
+
+    memcpy(sorted, ns, repetitions * sizeof(double));
+    qsort(sorted, repetitions, sizeof(double), compareDoubles);
+    int middle = 0;
+    for (int i = 0; i < repetitions; i++)
+    {
+        if (ns[i] == sorted[repetitions / 2]) middle = i;
+    }
+
+    snprintf(r->workload, sizeof(r->workload), "%s", workload);
+    snprintf(r->engine, sizeof(r->engine), "%s", engineNames8080[engine]);
+    r->repetitions = repetitions;
+    r->instructions = instructions;
+    r->ns = sorted[repetitions / 2];
+    r->best = sorted[0];
+    r->mhz = mhz[middle];
+    r->spread = 100 * sqrt(variance) / mean;
+    printf("%-10s %-7s %8.1f MHz %8.2f ns/instruction (best %6.2f)  +-%5.1f%%  (%llu instructions)\n",
+           r->workload, r->engine, r->mhz, r->ns, r->best, r->spread, (unsigned long long) r->instructions);
+}
+
+static void runProgram(Machine8080 **machines, const Program8080 *program, int engine, int repetitions)
+{
+    double ns[MAX_REPETITIONS], mhz[MAX_REPETITIONS];
+    uint64_t instructions = 0;
+
+    for (int i = 0; i < repetitions; i++)
+    {
+        Machine8080 *m = machines[i];
+        m->engine = engine;
+        resetMachine8080(m);
+        memcpy(m->memory, program->code, program->size);
+
+        double start = now();
+        engines8080[engine](m, SYNTHETIC_CYCLES);
+        double elapsed = now() - start;
+
+        instructions = m->instructions;
+        ns[i] = elapsed * 1e9 / m->instructions;
+        mhz[i] = m->cycles / elapsed / 1e6;
+    }
+    addResult(program->name, engine, ns, mhz, repetitions, instructions);
+}
+
+static void runInvaders(Machine8080 **machines, int engine, int repetitions)
+{
+    double ns[MAX_REPETITIONS], mhz[MAX_REPETITIONS];
+    uint64_t instructions = 0;
+
+    for (int i = 0; i < repetitions; i++)
+    {
+        Machine8080 *m = machines[i];
+        m->engine = engine;
+        resetMachine8080(m);
+
+        double start = now();
+        for (int frame = 0; frame < FRAMES; frame++) runFrame8080(m, 0);
+        double elapsed = now() - start;
+
+        instructions = m->instructions;
+        ns[i] = elapsed * 1e9 / m->instructions;
+        mhz[i] = m->cycles / elapsed / 1e6;
+    }
+    addResult("invaders", engine, ns, mhz, repetitions, instructions);
+}
+
+static int writeResults(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL) return 0;
+
+    fprintf(f, "# workload\tengine\trepetitions\tinstructions\tmhz\tns_per_instruction\tbest_ns_per_instruction\tspread_percent\n");
+    for (int i = 0; i < resultCount; i++)
+    {
+        Result8080 *r = &results[i];
+        fprintf(f, "%s\t%s\t%d\t%llu\t%.2f\t%.4f\t%.4f\t%.2f\n", r->workload, r->engine, r->repetitions,
+                (unsigned long long) r->instructions, r->mhz, r->ns, r->best, r->spread);
+    }
+    return fclose(f) == 0;
+}
+
+// Parse one line written by writeResults. Returns 0 for comments and bad lines.
+static int readResult(const char *line, Result8080 *r)
+{
+    unsigned long long instructions;
+
+    if (line[0] == '#') return 0;
+    if (sscanf(line, "%31s %15s %d %llu %lf %lf %lf %lf", r->workload, r->engine, &r->repetitions, &instructions,
+               &r->mhz, &r->ns, &r->best, &r->spread) != 8) return 0;
+    r->instructions = instructions;
+    return 1;
+}
+
+static Result8080 *findResult(const char *workload, const char *engine)
+{
+    for (int i = 0; i < resultCount; i++)
+    {
+        if (strcmp(results[i].workload, workload) == 0 && strcmp(results[i].engine, engine) == 0) return &results[i];
+    }
+    return NULL;
+}
+
+// Returns the number of regressions, counting workloads that executed a different
+// number of instructions, or -1 if the baseline cannot be read
+static int compareBaseline(const char *path, double tolerance)
+{
+    char line[256];
+    int regressions = 0;
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return -1;
+
+    printf("\nfastest runs against %s (%.0f%% tolerance):\n", path, tolerance);
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        Result8080 old, *r;
+
+        if (!readResult(line, &old) || (r = findResult(old.workload, old.engine)) == NULL) continue;
+
+        double change = 100 * (r->best - old.best) / old.best;
+        int regressed = change > tolerance;
+        int diverged = r->instructions != old.instructions;
+        regressions += regressed || diverged;
+        printf("%-10s %-7s %8.2f -> %8.2f ns/instruction  %+6.1f%%%s\n", r->workload, r->engine, old.best, r->best, change, regressed ? "  REGRESSION" : "");
+        if (diverged)
+        {
+            printf("%-10s %-7s %llu instructions, baseline has %llu  DIVERGED\n", r->workload, r->engine,
+                   (unsigned long long) r->instructions, (unsigned long long) old.instructions);
+        }
+    }
+    fclose(f);
+    return regressions;
+}
+
+// Print the speedup of every workload over another build's results, on the
+// fastest run as the baseline check does, and the geometric mean over all of them. Returns the geometric mean,
+// or 0 if the results cannot be read or share no workload with these.
+static double compareSpeedup(const char *path)
+{
+    char line[256];
+    double logs = 0;
+    int count = 0;
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return 0;
+
+    printf("\nspeedup over %s:\n", path);
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        Result8080 old, *r;
+
+        if (!readResult(line, &old) || (r = findResult(old.workload, old.engine)) == NULL) continue;
+
+        double speedup = old.best / r->best;
+        logs += log(speedup);
+        count++;
+        printf("%-10s %-7s %8.2f -> %8.2f ns/instruction  %5.2fx\n", r->workload, r->engine, old.best, r->best, speedup);
+    }
+    fclose(f);
+    if (count == 0) return 0;
+    printf("geometric mean speedup %.2fx over %d workloads\n", exp(logs / count), count);
+    return exp(logs / count);
+}
+
+int main(int argc, char** argv)
+{
+    static Machine8080 *machines[MAX_REPETITIONS];
+    const char *romPath = NULL;
+    const char *outputPath = NULL;
+    const char *baselinePath = NULL;
+    const char *speedupPath = NULL;
+    double tolerance = 50;
+    int repetitions = DEFAULT_REPETITIONS;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) repetitions = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) outputPath = argv[++i];
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) baselinePath = argv[++i];
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) tolerance = atof(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) speedupPath = argv[++i];
+        else romPath = argv[i];
+    }
+    if (romPath == NULL) {
+        printf("usage: %s [-n repetitions] [-o results] [-b baseline [-t percent]] [-s results] rom\n", argv[0]);
+        exit(1);
+    }
+    if (repetitions < 1) repetitions = 1;
+    if (repetitions > MAX_REPETITIONS) repetitions = MAX_REPETITIONS;
+
+    // Each repetition runs on a machine of its own. Some workloads run up to twice
+    // as fast or slow depending on where the machine, its memory and its block
+    // cache land relative to each other, which changes from process to process
+    // with address randomisation; spreading the repetitions over several layouts
+    // keeps the fastest run, and mostly the median, steady from one process to the next.
+    initDispatch8080();
+    for (int i = 0; i < repetitions; i++)
+    {
+        machines[i] = malloc(sizeof(Machine8080));
+        if (machines[i] == NULL || !initMachine8080(machines[i]))
+        {
+            printf("error: could not allocate a machine\n");
+            exit(2);
+        }
+        machines[i]->idleSkip = 0;
+    }
+
+    printf("median of %d runs; synthetic programs run %d states, invaders %d frames\n", repetitions, SYNTHETIC_CYCLES, FRAMES);
+    for (size_t p = 0; p < sizeof(programs8080) / sizeof(programs8080[0]); p++)
+    {
+        for (int engine = ENGINE_GOTO; engine <= ENGINE_BLOCKS; engine++) runProgram(machines, &programs8080[p], engine, repetitions);
+    }
+
+    for (int i = 0; i < repetitions; i++)
+    {
+        if (!loadRom8080(machines[i], romPath))
+        {
+            printf("error: could not read file %s\n", romPath);
+            exit(2);
+        }
+    }
+    for (int engine = ENGINE_GOTO; engine <= ENGINE_BLOCKS; engine++) runInvaders(machines, engine, repetitions);
+#ifdef WITH_AOT8080
+    if (initAot8080(machines[0])) runInvaders(machines, ENGINE_AOT, repetitions);
+#endif
+    for (int i = 0; i < repetitions; i++)
+    {
+        freeMachine8080(machines[i]);
+        free(machines[i]);
+    }
+
+    if (outputPath != NULL && !writeResults(outputPath))
+    {
+        printf("error: could not write %s\n", outputPath);
+        exit(2);
+    }
+    int status = 0;
+    if (speedupPath != NULL)
+    {
+        double speedup = compareSpeedup(speedupPath);
+        if (speedup == 0)
+        {
+            printf("error: could not read results %s\n", speedupPath);
+            exit(2);
+        }
+        if (speedup < 1)
+        {
+            printf("SLOWER: this build is %.1f%% slower than %s\n", 100 * (1 - speedup), speedupPath);
+            status = 1;
+        }
+    }
+    if (baselinePath != NULL)
+    {
+        int regressions = compareBaseline(baselinePath, tolerance);
+        if (regressions < 0)
+        {
+            printf("error: could not read baseline %s\n", baselinePath);
+            exit(2);
+        }
+        if (regressions > 0)
+        {
+            printf("%d regression%s\n", regressions, regressions == 1 ? "" : "s");
+            status = 1;
+        }
+    }
+    return status;
+}
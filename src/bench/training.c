@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "../cpu8080.h"
+#include "../io8080.h"
+#include "../replay8080.h"
+#include "../rom8080.h"
+
+// Writes the input log the release build is trained on (make training_log). A
+// scripted player inserts a coin and starts a one-player game, then holds fire
+// for 20 frames out of every 40, moves left through every other 200 frames and
+// right for 50 out of every 150 frames in between, until the last life is lost.
+// The log has a single checkpoint at frame 0, as the training replays it from
+// the start.
+//
+// Usage: training rom log
+
+#define FRAMES 3600
+#define PLAY_FROM 400
+
+// Invaders input port 1
+#define PORT1_COIN 0x01
+#define PORT1_START1 0x04
+#define PORT1_ALWAYS 0x08
+#define PORT1_FIRE 0x10
+#define PORT1_LEFT 0x20
+#define PORT1_RIGHT 0x40
+
+static uint8_t scriptedInput(int frame)
+{
+    uint8_t input = PORT1_ALWAYS;
+
+    if (frame >= 100 && frame < 110) input |= PORT1_COIN;
+    if (frame >= 200 && frame < 210) input |= PORT1_START1;
+    if (frame > PLAY_FROM)
+    {
+        if ((frame / 20) % 2) input |= PORT1_FIRE;
+        if ((frame / 200) % 2) input |= PORT1_LEFT;
+        else if ((frame / 50) % 3 == 0) input |= PORT1_RIGHT;
+    }
+    return input;
+}
+
+int main(int argc, char** argv)
+{
+    static Machine8080 machine;
+    static Recorder8080 recorder;
+    Machine8080 *m = &machine;
+    IoBus8080 bus;
+
+    if (argc < 3)
+    {
+        printf("usage: %s rom log\n", argv[0]);
+        exit(1);
+    }
+    if (!initMachine8080(m) || !loadRom8080(m, argv[1]))
+    {
+        printf("error: could not read file %s\n", argv[1]);
+        exit(2);
+    }
+    initDispatch8080();
+    initBus8080(&bus);
+    m->bus = &bus;
+
+    if (!openRecording8080(&recorder, argv[2], FRAMES, m))
+    {
+        printf("error: could not write %s\n", argv[2]);
+        exit(2);
+    }
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        m->input[0] = scriptedInput(frame);
+        recordFrame8080(&recorder, m, frame);
+        runFrame8080(m, 0);
+    }
+    printf("%d frames, %llu input changes\n", FRAMES, (unsigned long long) recorder.events);
+    closeRecording8080(&recorder);
+    freeMachine8080(m);
+    return 0;
+}
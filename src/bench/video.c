@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "../cpu8080.h"
+#include "../rom8080.h"
+#include "../video8080.h"
+
+// Benchmark for the framebuffer converter. Runs the ROM until there is a picture
+// on the screen, then converts the same video RAM over and over with
+//   naive:  one pixel per iteration, testing each bit of each video byte
+//   scalar: the 8x8 bit transpose kernel
+//   sse2:   16x16 byte transposes in SSE2 registers
+//   avx2:   two 16x16 byte transposes per AVX2 register
+// for each pixel format, checks every kernel against the naive output and reports
+// host ns per converted frame. It then keeps running the ROM and updates a frame
+// from the dirty video RAM lines only, reporting how many frames were unchanged,
+// how many lines a frame dirties and what an update costs against a full
+// conversion.
+
+#define FRAMES 600
+#define CONVERSIONS 2000
+#define REPETITIONS 5
+
+static const char *kernelNames[KERNEL_COUNT8080] = { "scalar", "sse2", "avx2" };
+static const char *formatNames[] = { "gray", "rgba", "overlay" };
+
+static void convertNaive8080(Video8080 *v, const Machine8080 *m)
+{
+    const uint8_t *vram = m->memory + VRAM_START8080;
+
+    for (int x = 0; x < SCREEN_WIDTH8080; x++)
+    {
+        for (int y = 0; y < SCREEN_HEIGHT8080; y++)
+        {
+            int offset = x * VRAM_COLUMN8080 + (SCREEN_HEIGHT8080 - 1 - y) / 8;
+            int lit = (vram[offset] >> ((SCREEN_HEIGHT8080 - 1 - y) % 8)) & 1;
+            if (v->format == PIXELS_GRAY8080) ((uint8_t *) v->pixels)[y * SCREEN_WIDTH8080 + x] = lit ? 0xFF : 0x00;
+            else ((uint32_t *) v->pixels)[y * SCREEN_WIDTH8080 + x] = lit ? v->rows[y][x] : 0;
+        }
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double measure(Video8080 *v, const Machine8080 *m, void (*convert)(Video8080 *, const Machine8080 *))
+{
+    double best = 1e30;
+
+    for (int i = 0; i < REPETITIONS; i++)
+    {
+        double start = now();
+        for (int j = 0; j < CONVERSIONS; j++)
+        {
+            convert(v, m);
+            __asm__ volatile("" : : "r"(v->pixels) : "memory");
+        }
+        double elapsed = now() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best * 1e9 / CONVERSIONS;
+}
+
+int main(int argc, char** argv)
+{
+    Machine8080 machine;
+    Machine8080 *m = &machine;
+    int failed = 0;
+
+    if (argc < 2) {
+        printf("usage: %s rom\n", argv[0]);
+        exit(1);
+    }
+    if (!initMachine8080(m) || !loadRom8080(m, argv[1]))
+    {
+        printf("error: could not read file %s\n", argv[1]);
+        exit(2);
+    }
+
+    initDispatch8080();
+    for (int i = 0; i < FRAMES; i++) runFrame8080(m, 0);
+
+    int lit = 0;
+    for (int i = 0; i < VRAM_SIZE8080; i++) lit += __builtin_popcount(m->memory[VRAM_START8080 + i]);
+    printf("screen after %d frames: %d of %d pixels lit; best of %d x %d conversions\n",
+           FRAMES, lit, SCREEN_WIDTH8080 * SCREEN_HEIGHT8080, REPETITIONS, CONVERSIONS);
+
+    for (int format = PIXELS_GRAY8080; format <= PIXELS_OVERLAY8080; format++)
+    {
+        Video8080 reference, video;
+        size_t size = SCREEN_WIDTH8080 * SCREEN_HEIGHT8080 * (format == PIXELS_GRAY8080 ? 1 : 4);
+
+        if (!initVideo8080(&reference, format) || !initVideo8080(&video, format))
+        {
+            printf("error: out of memory\n");
+            exit(3);
+        }
+        convertNaive8080(&reference, m);
+        double naive = measure(&reference, m, convertNaive8080);
+        printf("%-8s naive  %9.1f ns/frame\n", formatNames[format], naive);
+
+        for (int kernel = 0; kernel < KERNEL_COUNT8080; kernel++)
+        {
+            if (!kernelSupported8080(kernel)) continue;
+            video.kernel = kernel;
+            memset(video.pixels, 0x55, size);
+            convertFrame8080(&video, m);
+            int same = memcmp(video.pixels, reference.pixels, size) == 0;
+            failed |= !same;
+
+            double ns = measure(&video, m, convertFrame8080);
+            printf("%-8s %-6s %9.1f ns/frame  %6.1fx over naive%s\n",
+                   formatNames[format], kernelNames[kernel], ns, naive / ns, same ? "" : "  MISMATCH");
+        }
+        freeVideo8080(&reference);
+        freeVideo8080(&video);
+    }
+
+    // Dirty tracking, with the default kernel and gray pixels
+    Video8080 full, partial;
+    uint64_t dirty[VRAM_DIRTY_WORDS8080];
+    uint64_t lines = 0;
+    int unchanged = 0;
+    double updateTime = 0, fullTime = 0;
+
+    if (!initVideo8080(&full, PIXELS_GRAY8080) || !initVideo8080(&partial, PIXELS_GRAY8080))
+    {
+        printf("error: out of memory\n");
+        exit(3);
+    }
+    convertFrame8080(&partial, m);
+    takeVramDirty8080(m, dirty);
+    for (int i = 0; i < FRAMES; i++)
+    {
+        runFrame8080(m, 0);
+
+        double start = now();
+        if (takeVramDirty8080(m, dirty)) updateFrame8080(&partial, m, dirty);
+        else unchanged++;
+        double middle = now();
+        convertFrame8080(&full, m);
+        double end = now();
+
+        updateTime += middle - start;
+        fullTime += end - middle;
+        for (int j = 0; j < VRAM_DIRTY_WORDS8080; j++) lines += __builtin_popcountll(dirty[j]);
+        if (memcmp(partial.pixels, full.pixels, SCREEN_WIDTH8080 * SCREEN_HEIGHT8080) != 0)
+        {
+            printf("dirty update differs from full conversion at frame %d\n", i);
+            failed = 1;
+            break;
+        }
+    }
+    printf("dirty: %d of %d frames unchanged, %.1f of %d lines dirty per frame, update %.1f ns/frame vs full %.1f ns/frame\n",
+           unchanged, FRAMES, (double) lines / FRAMES, VRAM_LINES8080, updateTime * 1e9 / FRAMES, fullTime * 1e9 / FRAMES);
+    freeVideo8080(&full);
+    freeVideo8080(&partial);
+
+    return failed;
+}
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "block8080.h"
+#include "handlers8080.h"
+#include "memory8080.h"
+
+// Blocks and their micro-ops live in fixed pools; when either runs out the whole
+// cache is flushed and rebuilt on demand
+#define BLOCK_POOL 8192
+#define OP_POOL (BLOCK_POOL * 8)
+
+// Each machine gets its own cache the first time it runs on the block engine
+struct BlockCache8080
+{
+    Block8080 blocks[BLOCK_POOL];
+    MicroOp8080 ops[OP_POOL];
+    int blocksUsed;
+    int opsUsed;
+    Block8080 *map[MEMORY_SIZE8080];    // Cached block starting at each address, or NULL
+};
+
+
+// Stores into the host page, and its mirrors, now need to go through the memory
+// map's handler
+static inline void markPage8080(Machine8080 *m, int page)
+{
+    if ((m->codePages[page >> 6] >> (page & 63)) & 1) return;
+    m->codePages[page >> 6] |= 1ULL << (page & 63);
+    remapPage8080(m, page);
+}
+
+// Instructions after which execution does not simply fall through
+static int endsBlock8080(int kind)
+{
+    switch (kind)
+    {
+        case OP_JMP: case OP_JCC: case OP_CALL: case OP_CCC: case OP_RET:
+        case OP_RCC: case OP_RST: case OP_PCHL: case OP_HLT:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Give every page that held cached code its direct stores back
+static void clearPages8080(Machine8080 *m)
+{
+    for (int page = 0; page < 256; page++)
+    {
+        if (!((m->codePages[page >> 6] >> (page & 63)) & 1)) continue;
+        m->codePages[page >> 6] &= ~(1ULL << (page & 63));
+        remapPage8080(m, page);
+    }
+}
+
+void flushBlocks8080(Machine8080 *m)
+{
+    BlockCache8080 *cache = m->blocks;
+    if (cache != NULL)
+    {
+        memset(cache->map, 0, sizeof(cache->map));
+        cache->blocksUsed = 0;
+        cache->opsUsed = 0;
+    }
+    clearPages8080(m);
+    m->blockExit = 1;
+}
+
+void freeBlocks8080(Machine8080 *m)
+{
+    free(m->blocks);
+    m->blocks = NULL;
+    clearPages8080(m);
+}
+
+void invalidateCode8080(Machine8080 *m, uint16_t address)
+{
+    int page = address >> 8;
+
+    // The code may have run from any mirror of the page
+    for (int mirror = 0; mirror < 256; mirror++)
+    {
+        if (m->pageTargets[mirror] != page) continue;
+        uint32_t pageStart = mirror << 8;
+        uint32_t pageEnd = pageStart + 256;
+        uint32_t first = pageStart > BLOCK_MAX_BYTES ? pageStart - BLOCK_MAX_BYTES : 0;
+
+        // Blocks that start up to BLOCK_MAX_BYTES before the page may run into it
+        for (uint32_t start = first; start < pageEnd; start++)
+        {
+            Block8080 *block = m->blocks->map[start];
+            if (block != NULL && block->end > pageStart) m->blocks->map[start] = NULL;
+        }
+    }
+
+    m->codePages[page >> 6] &= ~(1ULL << (page & 63));
+    remapPage8080(m, page);
+    m->blockExit = 1;
+}
+
+static Block8080 *compileBlock8080(Machine8080 *m, uint16_t start)
+{
+    BlockCache8080 *cache = m->blocks;
+    if (cache->blocksUsed == BLOCK_POOL || cache->opsUsed + BLOCK_MAX_OPS > OP_POOL) flushBlocks8080(m);
+
+    Block8080 *block = &cache->blocks[cache->blocksUsed++];
+    block->start = start;
+    block->ops = &cache->ops[cache->opsUsed];
+    block->count = 0;
+
+    uint32_t address = start;
+    while (block->count < BLOCK_MAX_OPS)
+    {
+        const uint8_t *instruction = &m->memory[address];
+        const Dispatch8080 *entry = &dispatch8080[*instruction];
+        MicroOp8080 *op = &block->ops[block->count++];
+
+        op->entry = *entry;
+        memcpy(op->bytes, instruction, 3);
+        address += entry->length;
+        op->next = address;
+
+        // Stop at control flow and at the top of memory
+        if (endsBlock8080(entry->kind) || address + 3 > MEMORY_SIZE8080) break;
+    }
+    block->end = address;
+    cache->opsUsed += block->count;
+
+    for (uint32_t page = start >> 8; page <= (address - 1) >> 8; page++) markPage8080(m, m->pageTargets[page]);
+    cache->map[start] = block;
+    return block;
+}
+
+#ifdef __GNUC__
+uint64_t runBlocks8080(Machine8080 *m, uint64_t budget)
+{
+    #define LABELADDRESS8080(name) &&label_##name,
+    static void *const labels[OP_KIND_COUNT] = { OPKINDS8080(LABELADDRESS8080) };
+    #undef LABELADDRESS8080
+    uint64_t start = m->cycles;
+    uint64_t instructions = 0;
+    const MicroOp8080 *op;
+    const MicroOp8080 *end;
+    Block8080 *block;
+
+    if (m->blocks == NULL && (m->blocks = calloc(1, sizeof(BlockCache8080))) == NULL) return 0;
+    m->target = start + budget;
+
+    #define RUNOP8080() \
+        m->pc = op->next; \
+        m->cycles += op->entry.cycles; \
+        goto *labels[op->entry.kind]
+
+    // A store may have invalidated the running block, so leave it when told to
+    #define NEXTOP8080() \
+        if (++op == end || m->cycles >= m->target || m->blockExit) goto blockDone; \
+        RUNOP8080()
+
+    while (m->cycles < m->target)
+    {
+        block = m->blocks->map[m->pc];
+        if (block == NULL) block = compileBlock8080(m, m->pc);
+        op = block->ops;
+        end = op + block->count;
+        m->blockExit = 0;
+
+        RUNOP8080();
+
+        #define LABELBODY8080(name) label_##name: op_##name(m, op->bytes, &op->entry); NEXTOP8080();
+        OPKINDS8080(LABELBODY8080)
+        #undef LABELBODY8080
+
+    blockDone:
+        instructions += op - block->ops;
+    }
+    #undef RUNOP8080
+    #undef NEXTOP8080
+
+    m->instructions += instructions;
+    return m->cycles - start;
+}
+#else
+uint64_t runBlocks8080(Machine8080 *m, uint64_t budget)
+{
+    uint64_t start = m->cycles;
+
+    if (m->blocks == NULL && (m->blocks = calloc(1, sizeof(BlockCache8080))) == NULL) return 0;
+    m->target = start + budget;
+
+    while (m->cycles < m->target)
+    {
+        Block8080 *block = m->blocks->map[m->pc];
+        if (block == NULL) block = compileBlock8080(m, m->pc);
+        m->blockExit = 0;
+
+        for (int i = 0; i < block->count; i++)
+        {
+            const MicroOp8080 *op = &block->ops[i];
+            m->pc = op->next;
+            m->cycles += op->entry.cycles;
+            m->instructions++;
+            op->entry.handler(m, op->bytes, &op->entry);
+            if (m->cycles >= m->target || m->blockExit) break;
+        }
+    }
+    return m->cycles - start;
+}
+#endif
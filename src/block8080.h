@@ -0,0 +1,45 @@
+#ifndef BLOCK8080_H
+#define BLOCK8080_H
+
+#include <stdint.h>
+
+#include "cpu8080.h"
+
+// Predecoded basic-block cache. A block is a straight-line run of instructions
+// ending at the first JMP/CALL/RET/RST/Jcc/Ccc/Rcc/PCHL/HLT, decoded once into an
+// array of micro-ops whose dispatch entry and operand bytes are already resolved.
+// Stores into a page that holds cached code invalidate every block touching that
+// page, so self-modifying RAM code stays correct.
+
+#define BLOCK_MAX_OPS 64
+#define BLOCK_MAX_BYTES (BLOCK_MAX_OPS * 3)
+
+typedef struct
+{
+    Dispatch8080 entry;         // Handler, states and operand fields
+    uint8_t bytes[3];           // The instruction bytes, for immediate operands
+    uint16_t next;              // Address of the following instruction
+} MicroOp8080;
+
+typedef struct
+{
+    uint16_t start;             // Address of the first instruction
+    uint32_t end;               // Address just past the last instruction
+    uint16_t count;             // Number of micro-ops
+    MicroOp8080 *ops;
+} Block8080;
+
+// Drop every cached block overlapping the host page address lies in, or any of
+// its mirrors
+void invalidateCode8080(Machine8080 *m, uint16_t address);
+// Drop all cached blocks
+void flushBlocks8080(Machine8080 *m);
+// Release the machine's cache
+void freeBlocks8080(Machine8080 *m);
+
+// Execute whole blocks until at least budget states have passed. Results are
+// identical to the interpreter loops: the budget is still checked per instruction.
+// The machine's cache is allocated on the first call.
+uint64_t runBlocks8080(Machine8080 *m, uint64_t budget);
+
+#endif
@@ -0,0 +1,289 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "block8080.h"
+#include "cpu8080.h"
+#include "handlers8080.h"
+#include "memory8080.h"
+#include "schedule8080.h"
+#include "profile8080.h"
+#include "trace8080.h"
+
+const uint8_t szpTable8080[256] = {
+    0x44, 0x00, 0x00, 0x04, 0x00, 0x04, 0x04, 0x00, 0x00, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00, 0x04,
+    0x00, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x04, 0x00, 0x04, 0x04, 0x00,
+    0x00, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x04, 0x00, 0x04, 0x04, 0x00,
+    0x04, 0x00, 0x00, 0x04, 0x00, 0x04, 0x04, 0x00, 0x00, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00, 0x04,
+    0x00, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x04, 0x00, 0x04, 0x04, 0x00,
+    0x04, 0x00, 0x00, 0x04, 0x00, 0x04, 0x04, 0x00, 0x00, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00, 0x04,
+    0x04, 0x00, 0x00, 0x04, 0x00, 0x04, 0x04, 0x00, 0x00, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00, 0x04,
+    0x00, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x04, 0x00, 0x04, 0x04, 0x00,
+    0x80, 0x84, 0x84, 0x80, 0x84, 0x80, 0x80, 0x84, 0x84, 0x80, 0x80, 0x84, 0x80, 0x84, 0x84, 0x80,
+    0x84, 0x80, 0x80, 0x84, 0x80, 0x84, 0x84, 0x80, 0x80, 0x84, 0x84, 0x80, 0x84, 0x80, 0x80, 0x84,
+    0x84, 0x80, 0x80, 0x84, 0x80, 0x84, 0x84, 0x80, 0x80, 0x84, 0x84, 0x80, 0x84, 0x80, 0x80, 0x84,
+    0x80, 0x84, 0x84, 0x80, 0x84, 0x80, 0x80, 0x84, 0x84, 0x80, 0x80, 0x84, 0x80, 0x84, 0x84, 0x80,
+    0x84, 0x80, 0x80, 0x84, 0x80, 0x84, 0x84, 0x80, 0x80, 0x84, 0x84, 0x80, 0x84, 0x80, 0x80, 0x84,
+    0x80, 0x84, 0x84, 0x80, 0x84, 0x80, 0x80, 0x84, 0x84, 0x80, 0x80, 0x84, 0x80, 0x84, 0x84, 0x80,
+    0x80, 0x84, 0x84, 0x80, 0x84, 0x80, 0x80, 0x84, 0x84, 0x80, 0x80, 0x84, 0x80, 0x84, 0x84, 0x80,
+    0x84, 0x80, 0x80, 0x84, 0x80, 0x84, 0x84, 0x80, 0x80, 0x84, 0x84, 0x80, 0x84, 0x80, 0x80, 0x84,
+};
+
+uint64_t (*engines8080[ENGINE_COUNT])(Machine8080 *m, uint64_t budget) = { runGoto8080, runTable8080, runBlocks8080, NULL };
+
+Dispatch8080 dispatch8080[256];
+
+// Out-of-line wrappers for the function-pointer backend
+#define WRAPPER8080(name) static void handle_##name(Machine8080 *m, const uint8_t *instruction, const Dispatch8080 *e) { op_##name(m, instruction, e); }
+OPKINDS8080(WRAPPER8080)
+#undef WRAPPER8080
+
+#define HANDLERENTRY8080(name) handle_##name,
+const Handler8080 handlers8080[OP_KIND_COUNT] = { OPKINDS8080(HANDLERENTRY8080) };
+#undef HANDLERENTRY8080
+
+
+void initDispatch8080(void)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        const Opcode8080 *op = &opcodes8080[i];
+        dispatch8080[i].handler = handlers8080[op->kind];
+        dispatch8080[i].kind = op->kind;
+        dispatch8080[i].length = op->length;
+        dispatch8080[i].cycles = op->cycles;
+        dispatch8080[i].cyclesTaken = op->cyclesTaken;
+        dispatch8080[i].dst = op->dst;
+        dispatch8080[i].src = op->src;
+    }
+}
+
+int initMachine8080(Machine8080 *m)
+{
+    memset(m, 0, sizeof(*m));
+
+    // One spare page past 0xFFFF, mapped onto the bottom of memory, lets operand
+    // fetches of an instruction at the very top wrap around as they would on the
+    // chip. Shared so that mirrors can alias the same pages.
+    size_t size = MEMORY_SIZE8080 + sysconf(_SC_PAGESIZE);
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return 0;
+
+    m->memory = memory;
+    if (!mapMemory8080(m, 256))
+    {
+        freeMachine8080(m);
+        return 0;
+    }
+    m->engine = ENGINE_BLOCKS;
+    m->idleSkip = 1;
+    resetMachine8080(m);
+    return 1;
+}
+
+void freeMachine8080(Machine8080 *m)
+{
+    if (m->memory != NULL) munmap(m->memory, MEMORY_SIZE8080 + sysconf(_SC_PAGESIZE));
+    m->memory = NULL;
+    freeBlocks8080(m);
+}
+
+void resetMachine8080(Machine8080 *m)
+{
+    uint64_t oldCycles = m->cycles;
+
+    memset(m->registers, 0, sizeof(m->registers));
+    // Clear the RAM; a mirror shares its pages with what it mirrors, ROM included
+    for (uint32_t address = m->romSize; address < MEMORY_SIZE8080; address = (address & ~0xFFu) + 256)
+    {
+        if (m->pageTargets[address >> 8] == address >> 8) memset(m->memory + address, 0, 256 - (address & 0xFF));
+    }
+    setFlags8080(m, 0);
+    m->SP = 65535;
+    m->pc = 0;
+    m->cycles = 0;
+    m->instructions = 0;
+    m->interruptsEnabled = 0;
+    m->pendingInterrupt = -1;
+    m->halted = 0;
+    m->idleBranch = -1;
+    m->idleCycles = 0;
+    // Bit 3 of port 1 is wired high; nothing pressed, DIP switches off
+    m->input[0] = 0x08;
+    m->input[1] = 0x00;
+    m->shiftOffset = 0;
+    m->shift = 0;
+    memset(m->portReads, 0, sizeof(m->portReads));
+    memset(m->portWrites, 0, sizeof(m->portWrites));
+    memset(m->vramDirty, 0xFF, sizeof(m->vramDirty));
+    rebaseEvents8080(m, oldCycles);
+    flushBlocks8080(m);
+}
+
+int takeVramDirty8080(Machine8080 *m, uint64_t dirty[VRAM_DIRTY_WORDS8080])
+{
+    uint64_t any = 0;
+
+    for (int i = 0; i < VRAM_DIRTY_WORDS8080; i++)
+    {
+        dirty[i] = m->vramDirty[i];
+        any |= dirty[i];
+        m->vramDirty[i] = 0;
+    }
+    return any != 0;
+}
+
+void interrupt8080(Machine8080 *m, int vector)
+{
+    // The board holds the request until the CPU accepts it
+    if (!m->interruptsEnabled)
+    {
+        m->pendingInterrupt = vector;
+        return;
+    }
+    m->pendingInterrupt = -1;
+
+    // The interrupt ends a HLT and returns to the instruction after it
+    if (m->halted)
+    {
+        m->halted = 0;
+        m->pc++;
+    }
+    if (m->profile != NULL) profileInterrupt8080(m->profile, m, vector << 3);
+    m->interruptsEnabled = 0;
+    push8080(m, m->pc);
+    m->pc = vector << 3;
+    m->cycles += opcodes8080[0xC7].cycles;
+}
+
+// Instructions an idle loop body may hold: they read memory at most and leave
+// the stack, the I/O ports and the interrupt flag alone
+static int idleKind8080(int kind)
+{
+    switch (kind)
+    {
+        case OP_NOP: case OP_LDAX: case OP_LHLD: case OP_LDA: case OP_INX: case OP_DCX: case OP_DAD:
+        case OP_INR: case OP_DCR: case OP_MVI: case OP_RLC: case OP_RRC: case OP_RAL: case OP_RAR:
+        case OP_DAA: case OP_CMA: case OP_STC: case OP_CMC: case OP_MOV: case OP_MOV_RM: case OP_XCHG:
+        case OP_ADD: case OP_ADC: case OP_SUB: case OP_SBB: case OP_ANA: case OP_XRA: case OP_ORA: case OP_CMP:
+        case OP_ADD_M: case OP_ADC_M: case OP_SUB_M: case OP_SBB_M: case OP_ANA_M: case OP_XRA_M: case OP_ORA_M: case OP_CMP_M:
+        case OP_ADI: case OP_ACI: case OP_SUI: case OP_SBI: case OP_ANI: case OP_XRI: case OP_ORI: case OP_CPI:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+void idleLoop8080(Machine8080 *m, uint16_t branch)
+{
+    uint8_t flags = getFlags8080(m);
+    uint64_t elapsed = m->cycles - m->idleMark;
+    int repeated = m->idleBranch == branch && flags == m->idleFlags && m->SP == m->idleSP &&
+                   memcmp(m->registers, m->idleRegisters, sizeof(m->registers)) == 0;
+
+    m->idleBranch = branch;
+    m->idleMark = m->cycles;
+    m->idleFlags = flags;
+    m->idleSP = m->SP;
+    memcpy(m->idleRegisters, m->registers, sizeof(m->registers));
+    if (!repeated || m->cycles >= m->target) return;
+
+    // The body must run straight into the branch
+    uint64_t cycles = dispatch8080[m->memory[branch]].cycles;
+    uint64_t instructions = 1;
+    uint16_t address = m->pc;
+    while (address != branch)
+    {
+        const Dispatch8080 *e = &dispatch8080[m->memory[address]];
+        if (!idleKind8080(e->kind) || (uint16_t) (branch - address) < e->length) return;
+        cycles += e->cycles;
+        instructions++;
+        address += e->length;
+    }
+    // Anything else in between, an interrupt for one, took states of its own
+    if (elapsed != cycles) return;
+
+    uint64_t iterations = (m->target - m->cycles) / cycles;
+    m->cycles += iterations * cycles;
+    m->instructions += iterations * instructions;
+    m->idleCycles += iterations * cycles;
+    m->idleMark = m->cycles;
+}
+
+void idleHalt8080(Machine8080 *m)
+{
+    uint64_t cycles = dispatch8080[0x76].cycles;
+
+    if (m->cycles >= m->target) return;
+    uint64_t repeats = (m->target - m->cycles) / cycles;
+    m->cycles += repeats * cycles;
+    m->instructions += repeats;
+    m->idleCycles += repeats * cycles;
+}
+
+uint16_t emulateOp8080(Machine8080 *m, int address)
+{
+    const uint8_t *instruction = &m->memory[address];
+    const Dispatch8080 *entry = &dispatch8080[*instruction];
+
+    m->pc = address + entry->length;
+    m->cycles += entry->cycles;
+    m->instructions++;
+    entry->handler(m, instruction, entry);
+
+    // return the address of the next instruction
+    return m->pc;
+}
+
+// Plain loops: tracing and profiling cost nothing unless one of their variants is chosen
+#define RUNLOOP_TABLE runTable8080
+#define RUNLOOP_GOTO runGoto8080
+#define RUNLOOP_TRACE 0
+#define RUNLOOP_PROFILE 0
+#include "runloop8080.h"
+#undef RUNLOOP_TABLE
+#undef RUNLOOP_GOTO
+#undef RUNLOOP_TRACE
+#undef RUNLOOP_PROFILE
+
+#define RUNLOOP_TABLE runTableTraced8080
+#define RUNLOOP_GOTO runGotoTraced8080
+#define RUNLOOP_TRACE 1
+#define RUNLOOP_PROFILE 0
+#include "runloop8080.h"
+#undef RUNLOOP_TABLE
+#undef RUNLOOP_GOTO
+#undef RUNLOOP_TRACE
+#undef RUNLOOP_PROFILE
+
+#define RUNLOOP_TABLE runTableProfiled8080
+#define RUNLOOP_GOTO runGotoProfiled8080
+#define RUNLOOP_TRACE 0
+#define RUNLOOP_PROFILE 1
+#include "runloop8080.h"
+#undef RUNLOOP_TABLE
+#undef RUNLOOP_GOTO
+#undef RUNLOOP_TRACE
+#undef RUNLOOP_PROFILE
+
+uint64_t runFrame8080(Machine8080 *m, int traced)
+{
+    uint64_t (*run)(Machine8080 *, uint64_t) = traced ? runGotoTraced8080 : m->profile != NULL ? runGotoProfiled8080 : engines8080[m->engine];
+    uint64_t start = m->cycles;
+    uint64_t frameEnd = (m->cycles / FRAME_CYCLES8080 + 1) * FRAME_CYCLES8080;
+    int idleSkip = m->idleSkip;
+
+    // Traces and profiles see every iteration of an idle loop
+    if (traced || m->profile != NULL) m->idleSkip = 0;
+    do
+    {
+        uint64_t deadline = nextEvent8080(m, frameEnd);
+        if (m->cycles < deadline) run(m, deadline - m->cycles);
+        runEvents8080(m);
+    }
+    while (m->cycles < frameEnd);
+    m->idleSkip = idleSkip;
+
+    return m->cycles - start;
+}
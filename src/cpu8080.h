@@ -0,0 +1,289 @@
+#ifndef CPU8080_H
+#define CPU8080_H
+
+#include <stdint.h>
+
+#include "opcodes8080.h"
+
+// Bits of the flag register as they appear in the processor status word
+#define FLAG_S  0x80
+#define FLAG_Z  0x40
+#define FLAG_AC 0x10
+#define FLAG_P  0x04
+#define FLAG_CY 0x01
+
+// Space Invaders runs the 8080 at 2 MHz and draws 60 frames per second
+#define CLOCK_HZ8080 2000000
+#define FRAME_CYCLES8080 (CLOCK_HZ8080 / 60)
+
+// Its writable RAM, with the video RAM in the top 7 KiB of it
+#define RAM_START8080 0x2000
+#define RAM_SIZE8080 0x2000
+
+// The video RAM: 1 bit per pixel, one 32-byte line for each of the 224 columns
+// of the (rotated) picture
+#define VRAM_START8080 0x2400
+#define VRAM_SIZE8080 0x1C00
+#define VRAM_COLUMN8080 32
+#define VRAM_LINES8080 (VRAM_SIZE8080 / VRAM_COLUMN8080)
+#define VRAM_DIRTY_WORDS8080 ((VRAM_LINES8080 + 63) / 64)
+
+typedef struct Dispatch8080 Dispatch8080;
+typedef struct Machine8080 Machine8080;
+
+// Executes one instruction; pc already points past it when the handler runs
+typedef void (*Handler8080)(Machine8080 *m, const uint8_t *instruction, const Dispatch8080 *entry);
+
+// Precomputed entry for one opcode, so executing it needs no decoding at all
+struct Dispatch8080
+{
+    Handler8080 handler;
+    uint8_t kind;
+    uint8_t length;
+    uint8_t cycles;
+    uint8_t cyclesTaken;
+    uint8_t dst;
+    uint8_t src;
+};
+
+extern Dispatch8080 dispatch8080[256];
+extern const Handler8080 handlers8080[OP_KIND_COUNT];
+
+// S, Z and P of every possible result byte
+extern const uint8_t szpTable8080[256];
+
+// Memory space (2^16 addresses). Code is fetched from the same map that loads and
+// stores go through; the ROM images are mapped into its low pages by loadRom8080.
+#define MEMORY_SIZE8080 0x10000
+
+// Execution engine used by runFrame8080 for untraced runs
+enum
+{
+    ENGINE_GOTO,        // Computed-goto interpreter
+    ENGINE_TABLE,       // Function-pointer interpreter
+    ENGINE_BLOCKS,      // Predecoded basic-block cache (block8080.c)
+    ENGINE_AOT,         // Recompiled ROM (aot8080.c), only in builds that link it
+    ENGINE_COUNT
+};
+
+// Memory map handlers (memory8080.h), for pages that are not plain host memory
+typedef uint8_t (*ReadPage8080)(Machine8080 *m, uint16_t address);
+typedef void (*WritePage8080)(Machine8080 *m, uint16_t address, uint8_t value);
+
+#define WATCHPOINTS8080 16
+
+typedef struct
+{
+    uint16_t address;
+    uint8_t flags;              // WATCH_READ8080, WATCH_WRITE8080
+    uint64_t hits;
+} Watchpoint8080;
+
+// Scheduled events (schedule8080.h): a handler called once m->cycles reaches when
+typedef void (*EventHandler8080)(void *device, Machine8080 *m, uint64_t when);
+
+#define EVENTS8080 16
+
+typedef struct
+{
+    uint64_t when;
+    EventHandler8080 handler;
+    void *device;
+} Event8080;
+
+typedef struct BlockCache8080 BlockCache8080;
+typedef struct IoBus8080 IoBus8080;
+typedef struct Profile8080 Profile8080;
+
+// Everything one emulated machine owns. Any number of machines can run side by
+// side, each on its own thread; the dispatch and opcode tables are shared and
+// read-only once initDispatch8080 has run.
+struct Machine8080
+{
+    // In order, the registers are: B, C, D, E, H, L, N/A, A
+    uint8_t registers[8];
+#ifdef EAGER_FLAGS8080
+    // Eager flags: every ALU operation builds the whole flag byte (kept for comparison)
+    uint8_t flags;
+#else
+    // Lazy flags: ALU operations only record where each flag comes from, and the flag
+    // byte is assembled when PUSH PSW, DAA or a trace needs it. Conditional jumps,
+    // calls and returns test the single flag they need straight from these sources.
+    uint16_t flagResult;        // S and P come from bits 0-7, CY is bit 8
+    uint8_t flagZero;           // Z is set while this is zero
+    uint8_t flagAux;            // AC is bit 4
+#endif
+
+    // Instruction registers
+    uint16_t SP;
+    uint16_t pc;
+
+    // States and instructions executed since reset
+    uint64_t cycles;
+    uint64_t instructions;
+    int interruptsEnabled;
+    // RST vector raised while interrupts were disabled, taken once EI enables
+    // them, or -1
+    int pendingInterrupt;
+    // Set by HLT until the next interrupt
+    int halted;
+    // What IN 1 and IN 2 read: the cabinet's buttons and DIP switches
+    uint8_t input[2];
+    // Space Invaders shift register: OUT 4 shifts a byte in from the top, OUT 2
+    // sets how many bits below the top byte IN 3 reads from
+    uint8_t shiftOffset;
+    uint16_t shift;
+    // Devices attached to the I/O ports (io8080.h), or NULL for the Invaders board alone
+    IoBus8080 *bus;
+
+    // Host memory: the ROM, RAM and video RAM at their own addresses, with every
+    // mirror mapped onto the same host pages as what it mirrors (memory8080.h).
+    // Code is fetched from it directly; loads and stores go through the page map below.
+    uint8_t *memory;
+    // Bytes of ROM mapped from address 0x0000
+    uint32_t romSize;
+
+    // Memory map (memory8080.h), one entry per 256-byte page: the host page loads
+    // and stores go straight to, or NULL to call the page's handler instead
+    const uint8_t *readPages[256];
+    uint8_t *writePages[256];
+    ReadPage8080 readHandlers[256];
+    WritePage8080 writeHandlers[256];
+    // The host page each page maps to (itself, or the one it mirrors), and the
+    // PAGE_* kind of each host page
+    uint8_t pageTargets[256];
+    uint8_t pageKinds[256];
+    // Pages the address space repeats every, 256 when nothing is mirrored; 0
+    // until mapMemory8080 first runs
+    int decodedPages;
+    // Stores the ROM ignored
+    uint64_t romWrites;
+    Watchpoint8080 watchpoints[WATCHPOINTS8080];
+    int watchCount;
+    // Called on every watchpoint hit, if set
+    void (*watchHit)(Machine8080 *m, Watchpoint8080 *w, uint16_t address, uint8_t value, int write);
+
+    int engine;
+    // Guest profile (profile8080.h) that runFrame8080 feeds, or NULL
+    Profile8080 *profile;
+    // End of the running budget; every run loop sets it on entry and checks it
+    // after each instruction, so lowering it (as EI does to take a pending
+    // interrupt) ends the run early. Idle-loop skipping stops there too.
+    uint64_t target;
+    // Events due at future cycle counts, soonest first (schedule8080.h)
+    Event8080 events[EVENTS8080];
+    int eventCount;
+
+    // Idle-loop skipping (idleLoop8080), cleared to run every iteration for
+    // accuracy tests; the short backward branch last taken (-1: none) with the
+    // state it left behind, and the states skipped since reset
+    int idleSkip;
+    int idleBranch;
+    uint64_t idleMark;
+    uint8_t idleRegisters[8];
+    uint8_t idleFlags;
+    uint16_t idleSP;
+    uint64_t idleCycles;
+
+    // Block cache: one bit per host page that has cached blocks in it or its mirrors, set
+    // when the block being executed may have been invalidated, and the cache itself
+    uint64_t codePages[4];
+    int blockExit;
+    BlockCache8080 *blocks;
+
+    // One bit per video RAM line stored to since takeVramDirty8080 last cleared them
+    uint64_t vramDirty[VRAM_DIRTY_WORDS8080];
+
+    // IN and OUT instructions executed on each port since reset, for profiling
+    uint64_t portReads[256];
+    uint64_t portWrites[256];
+};
+
+#ifdef EAGER_FLAGS8080
+static inline uint8_t getFlags8080(Machine8080 *m)
+{
+    return m->flags;
+}
+
+static inline void setFlags8080(Machine8080 *m, uint8_t flags)
+{
+    m->flags = flags & (FLAG_S | FLAG_Z | FLAG_AC | FLAG_P | FLAG_CY);
+}
+#else
+static inline uint8_t getFlags8080(Machine8080 *m)
+{
+    return (szpTable8080[m->flagResult & 0xFF] & (FLAG_S | FLAG_P)) | (m->flagZero ? 0 : FLAG_Z) |
+           (m->flagAux & FLAG_AC) | ((m->flagResult >> 8) & FLAG_CY);
+}
+
+// Any combination is possible after POP PSW, so S and P get a byte of their own
+// that reproduces them: the sign bit, plus bit 0 when the parity needs fixing
+static inline void setFlags8080(Machine8080 *m, uint8_t flags)
+{
+    uint8_t sign = flags & FLAG_S;
+    uint8_t fix = (szpTable8080[sign] & FLAG_P) != (flags & FLAG_P);
+    m->flagResult = ((flags & FLAG_CY) << 8) | sign | fix;
+    m->flagZero = !(flags & FLAG_Z);
+    m->flagAux = flags & FLAG_AC;
+}
+#endif
+
+// Run loop of each engine; entries are NULL for engines not linked in
+extern uint64_t (*engines8080[ENGINE_COUNT])(Machine8080 *m, uint64_t budget);
+
+// Build dispatch8080 from the opcode table; must be called before executing anything
+void initDispatch8080(void);
+// Reserve the machine's address space and reset it; must be called before loading a ROM
+int initMachine8080(Machine8080 *m);
+// Release the address space and caches of a machine
+void freeMachine8080(Machine8080 *m);
+// Clear registers, flags and RAM (the ROM is left alone)
+void resetMachine8080(Machine8080 *m);
+// Copy the video RAM lines written since the last call into dirty and clear them
+// on the machine. Returns 0 when nothing was written, i.e. the frame is unchanged.
+int takeVramDirty8080(Machine8080 *m, uint64_t dirty[VRAM_DIRTY_WORDS8080]);
+// Raise RST vector: taken at once if interrupts are enabled, otherwise held
+// pending (replacing any vector already held) until EI enables them
+void interrupt8080(Machine8080 *m, int vector);
+
+// Furthest a backward JMP or Jcc can branch and still be checked for an idle loop
+#define IDLE_LOOP_BYTES8080 16
+
+// Idle loops: a taken JMP or Jcc at branch has just gone back to m->pc, at most
+// IDLE_LOOP_BYTES8080 before it. When the loop body is straight-line code that
+// only reads memory and works on registers (no stores, stack or I/O), and the
+// registers, flags and SP are the same as the last time the branch was taken one
+// iteration ago, every further iteration repeats it exactly until an interrupt
+// changes memory. The states and instructions of all the whole iterations that fit
+// before m->target are then added at once, leaving the loop exactly where running
+// it would have, and counted in m->idleCycles.
+void idleLoop8080(Machine8080 *m, uint16_t branch);
+// HLT repeats itself until an interrupt; add all the repeats that fit before m->target
+void idleHalt8080(Machine8080 *m);
+
+// Emulate step
+uint16_t emulateOp8080(Machine8080 *m, int address);
+
+// Execute instructions until at least budget states have passed, or m->target
+// was lowered below that, returning the number of states actually taken (the
+// last instruction may overshoot the budget)
+//   runTable8080: portable loop calling through the handler pointers
+//   runGoto8080:  threaded loop using computed goto (falls back to runTable8080 without GCC)
+// The *Traced8080 variants also log every instruction into the binary trace, and
+// the *Profiled8080 ones feed the machine's profile.
+uint64_t runTable8080(Machine8080 *m, uint64_t budget);
+uint64_t runGoto8080(Machine8080 *m, uint64_t budget);
+uint64_t runTableTraced8080(Machine8080 *m, uint64_t budget);
+uint64_t runGotoTraced8080(Machine8080 *m, uint64_t budget);
+uint64_t runTableProfiled8080(Machine8080 *m, uint64_t budget);
+uint64_t runGotoProfiled8080(Machine8080 *m, uint64_t budget);
+
+// Run one video frame, up to the next multiple of FRAME_CYCLES8080 states. The
+// engine runs uninterrupted from one scheduled event to the next, which include
+// the board's RST 1 (mid-screen) and RST 2 (end of frame); see schedule8080.h.
+// Traced frames run on runGotoTraced8080; otherwise a machine with a profile
+// attached runs on runGotoProfiled8080, and any other on its engine. Idle loops
+// are only skipped in frames that are neither traced nor profiled.
+uint64_t runFrame8080(Machine8080 *m, int traced);
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef DISASM8080_H
+#define DISASM8080_H
+
+// Print the instruction at buffer[pc] and return its size in bytes
+int disassembleOp8080(unsigned char *buffer, int pc);
+
+#endif
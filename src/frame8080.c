@@ -0,0 +1,120 @@
+#include <string.h>
+#include <time.h>
+
+#include "frame8080.h"
+
+
+int initExchange8080(FrameExchange8080 *x, int format)
+{
+    memset(x, 0, sizeof(*x));
+    for (int slot = 0; slot < 3; slot++)
+    {
+        if (!initVideo8080(&x->slots[slot], format))
+        {
+            freeExchange8080(x);
+            return 0;
+        }
+    }
+    // Every slot starts out of date in every line
+    memset(x->stale, 0xFF, sizeof(x->stale));
+    x->back = 0;
+    atomic_init(&x->middle, 1);
+    x->front = 2;
+    return 1;
+}
+
+void freeExchange8080(FrameExchange8080 *x)
+{
+    for (int slot = 0; slot < 3; slot++) freeVideo8080(&x->slots[slot]);
+}
+
+void publishFrame8080(FrameExchange8080 *x, Machine8080 *m, uint64_t number)
+{
+    uint64_t dirty[VRAM_DIRTY_WORDS8080];
+
+    takeVramDirty8080(m, dirty);
+    for (int slot = 0; slot < 3; slot++)
+    {
+        for (int i = 0; i < VRAM_DIRTY_WORDS8080; i++) x->stale[slot][i] |= dirty[i];
+    }
+    updateFrame8080(&x->slots[x->back], m, x->stale[x->back]);
+    memset(x->stale[x->back], 0, sizeof(x->stale[x->back]));
+    x->numbers[x->back] = number;
+
+    unsigned old = atomic_exchange_explicit(&x->middle, x->back | FRAME_FRESH8080, memory_order_acq_rel);
+    if (old & FRAME_FRESH8080) x->dropped++;
+    x->back = old & 3;
+    x->published++;
+}
+
+const Video8080 *takeFrame8080(FrameExchange8080 *x, uint64_t *number)
+{
+    if (atomic_load_explicit(&x->middle, memory_order_relaxed) & FRAME_FRESH8080)
+    {
+        unsigned old = atomic_exchange_explicit(&x->middle, x->front, memory_order_acq_rel);
+        x->front = old & 3;
+    }
+    else x->duplicated++;
+
+    x->presented++;
+    *number = x->numbers[x->front];
+    return &x->slots[x->front];
+}
+
+static void present8080(Presenter8080 *p)
+{
+    uint64_t number;
+    const Video8080 *frame = takeFrame8080(p->exchange, &number);
+
+    fputs("FRAME\n", p->file);
+    fwrite(frame->pixels, SCREEN_WIDTH8080, SCREEN_HEIGHT8080, p->file);
+    p->frames++;
+}
+
+static void *presenter8080(void *argument)
+{
+    Presenter8080 *p = argument;
+    struct timespec next;
+
+    // Absolute deadlines, so time spent writing does not add up into drift
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!atomic_load_explicit(&p->stop, memory_order_relaxed))
+    {
+        present8080(p);
+        next.tv_nsec += 1000000000L / p->rate;
+        if (next.tv_nsec >= 1000000000L)
+        {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    return NULL;
+}
+
+int startPresenter8080(Presenter8080 *p, FrameExchange8080 *x, const char *path, int rate)
+{
+    memset(p, 0, sizeof(*p));
+    p->exchange = x;
+    p->rate = rate > 0 ? rate : 60;
+    p->file = fopen(path, "wb");
+    if (p->file == NULL) return 0;
+    fprintf(p->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 Cmono\n", SCREEN_WIDTH8080, SCREEN_HEIGHT8080, p->rate);
+
+    atomic_init(&p->stop, 0);
+    if (pthread_create(&p->thread, NULL, presenter8080, p) != 0)
+    {
+        fclose(p->file);
+        return 0;
+    }
+    return 1;
+}
+
+void stopPresenter8080(Presenter8080 *p)
+{
+    atomic_store_explicit(&p->stop, 1, memory_order_relaxed);
+    pthread_join(p->thread, NULL);
+    // The last frame published may not have been shown yet
+    present8080(p);
+    fclose(p->file);
+}
@@ -0,0 +1,77 @@
+#ifndef FRAME8080_H
+#define FRAME8080_H
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "cpu8080.h"
+#include "video8080.h"
+
+// Frame handoff between the emulator thread and a presenter thread, as a
+// lock-free triple buffer. The emulator owns the back slot and draws each
+// finished frame straight into it, then swaps it with the middle slot in one
+// atomic exchange, marked fresh. The presenter owns the front slot and swaps it
+// with the middle one only when that is fresh, so it always shows the newest
+// frame. Neither side waits on the other and no frame is copied.
+//
+// A frame published over one the presenter never took counts as dropped, and a
+// present that finds nothing fresh shows the same frame again and counts as
+// duplicated.
+//
+// Slots are redrawn from the video RAM lines that changed, with updateFrame8080.
+// A slot misses the frames published while it was elsewhere, so the emulator
+// keeps, for each slot, the lines changed since that slot was last drawn.
+
+#define FRAME_FRESH8080 4
+
+typedef struct
+{
+    Video8080 slots[3];
+    uint64_t numbers[3];                            // Frame held by each slot
+
+    // Emulator side
+    _Alignas(64) int back;
+    uint64_t stale[3][VRAM_DIRTY_WORDS8080];        // Lines changed since each slot was drawn
+    uint64_t published;
+    uint64_t dropped;
+
+    // Middle slot, with FRAME_FRESH8080 set until the presenter takes it
+    _Alignas(64) atomic_uint middle;
+
+    // Presenter side
+    _Alignas(64) int front;
+    uint64_t presented;
+    uint64_t duplicated;
+} FrameExchange8080;
+
+// Slots in format (see video8080.h). Returns 0 if out of memory.
+int initExchange8080(FrameExchange8080 *x, int format);
+void freeExchange8080(FrameExchange8080 *x);
+// Emulator thread: draw the machine's screen into the back slot as frame number
+// and hand it over
+void publishFrame8080(FrameExchange8080 *x, Machine8080 *m, uint64_t number);
+// Presenter thread: the newest frame, which stays valid until the next call.
+// *number receives its frame number.
+const Video8080 *takeFrame8080(FrameExchange8080 *x, uint64_t *number);
+
+// Headless presenter: a thread that takes a frame rate times a second and writes
+// it to a YUV4MPEG2 (Y4M) file, luma only, for players and encoders to read
+typedef struct
+{
+    FrameExchange8080 *exchange;
+    FILE *file;
+    int rate;
+    atomic_int stop;
+    uint64_t frames;            // Frames written
+    pthread_t thread;
+} Presenter8080;
+
+// The exchange must hold PIXELS_GRAY8080 frames. Returns 0 if the file cannot be
+// written or the thread cannot start.
+int startPresenter8080(Presenter8080 *p, FrameExchange8080 *x, const char *path, int rate);
+// Present one last time, stop the thread and close the file
+void stopPresenter8080(Presenter8080 *p);
+
+#endif
@@ -0,0 +1,385 @@
+#ifndef HANDLERS8080_H
+#define HANDLERS8080_H
+
+#include <stdint.h>
+
+#include "block8080.h"
+#include "cpu8080.h"
+#include "io8080.h"
+
+// Instruction semantics shared by every execution engine: the interpreter loops in
+// cpu8080.c and the block cache in block8080.c include this header and dispatch
+// to the same static inline op_* handler bodies.
+
+#define REG_A 7
+
+
+// Memory and register pair helpers. Loads and stores go straight to the host page
+// when the memory map has one for the page, and through its handler otherwise
+// (memory8080.h): ROM, video RAM, pages holding cached code and watchpoints.
+static inline uint8_t readMemory8080(Machine8080 *m, uint16_t address)
+{
+    const uint8_t *page = m->readPages[address >> 8];
+
+    if (page != NULL) return page[address & 0xFF];
+    return m->readHandlers[address >> 8](m, address);
+}
+
+static inline void writeMemory8080(Machine8080 *m, uint16_t address, uint8_t value)
+{
+    uint8_t *page = m->writePages[address >> 8];
+
+    if (page != NULL) page[address & 0xFF] = value;
+    else m->writeHandlers[address >> 8](m, address, value);
+}
+
+static inline uint16_t hl8080(Machine8080 *m)
+{
+    return ((uint16_t) m->registers[4] << 8) | m->registers[5];
+}
+
+static inline uint16_t immediate8080(const uint8_t *instruction)
+{
+    return ((uint16_t) instruction[2] << 8) | instruction[1];
+}
+
+// Register pairs are B-C, D-E, H-L and SP
+static inline uint16_t getPair8080(Machine8080 *m, int rp)
+{
+    if (rp == 3) return m->SP;
+    return ((uint16_t) m->registers[rp << 1] << 8) | m->registers[(rp << 1) + 1];
+}
+
+static inline void setPair8080(Machine8080 *m, int rp, uint16_t value)
+{
+    if (rp == 3) { m->SP = value; return; }
+    m->registers[rp << 1] = value >> 8;
+    m->registers[(rp << 1) + 1] = value & 0xFF;
+}
+
+static inline void push8080(Machine8080 *m, uint16_t value)
+{
+    m->SP -= 2;
+    writeMemory8080(m, m->SP, value & 0xFF);
+    writeMemory8080(m, m->SP + 1, value >> 8);
+}
+
+static inline uint16_t pop8080(Machine8080 *m)
+{
+    uint16_t value = readMemory8080(m, m->SP) | ((uint16_t) readMemory8080(m, m->SP + 1) << 8);
+    m->SP += 2;
+    return value;
+}
+
+
+// Flag updates. An ALU result is passed with its carry in bit 8, and the auxiliary
+// carry as bit 4 of aux (a ^ value ^ result for additions, its complement for
+// subtractions). INR and DCR leave CY alone; rotates, DAD, STC and CMC touch only CY.
+#ifdef EAGER_FLAGS8080
+static inline void resultFlags8080(Machine8080 *m, uint16_t result, uint8_t aux)
+{
+    m->flags = szpTable8080[result & 0xFF] | (aux & FLAG_AC) | ((result >> 8) & FLAG_CY);
+}
+
+static inline void stepFlags8080(Machine8080 *m, uint8_t result, uint8_t aux)
+{
+    m->flags = (m->flags & FLAG_CY) | szpTable8080[result] | (aux & FLAG_AC);
+}
+
+static inline void setCarry8080(Machine8080 *m, int carry)
+{
+    m->flags = (m->flags & ~FLAG_CY) | carry;
+}
+
+static inline int carry8080(Machine8080 *m)
+{
+    return m->flags & FLAG_CY;
+}
+
+static inline int condition8080(Machine8080 *m, int cc)
+{
+    // Flags tested by each pair of condition codes (NZ/Z, NC/C, PO/PE, P/M)
+    static const uint8_t conditionFlags8080[4] = {FLAG_Z, FLAG_CY, FLAG_P, FLAG_S};
+    return ((m->flags & conditionFlags8080[cc >> 1]) != 0) == (cc & 1);
+}
+#else
+static inline void resultFlags8080(Machine8080 *m, uint16_t result, uint8_t aux)
+{
+    m->flagResult = result;
+    m->flagZero = result;
+    m->flagAux = aux;
+}
+
+static inline void stepFlags8080(Machine8080 *m, uint8_t result, uint8_t aux)
+{
+    m->flagResult = (m->flagResult & 0x100) | result;
+    m->flagZero = result;
+    m->flagAux = aux;
+}
+
+static inline void setCarry8080(Machine8080 *m, int carry)
+{
+    m->flagResult = (m->flagResult & 0xFF) | (carry << 8);
+}
+
+static inline int carry8080(Machine8080 *m)
+{
+    return (m->flagResult >> 8) & 1;
+}
+
+// Only the flag the condition tests is worked out
+static inline int condition8080(Machine8080 *m, int cc)
+{
+    int set;
+    switch (cc >> 1)
+    {
+        case 0: set = m->flagZero == 0; break;
+        case 1: set = carry8080(m); break;
+        case 2: set = (szpTable8080[m->flagResult & 0xFF] & FLAG_P) != 0; break;
+        default: set = (m->flagResult & 0x80) != 0; break;
+    }
+    return set == (cc & 1);
+}
+#endif
+
+static inline void add8080(Machine8080 *m, uint8_t value, int carry)
+{
+    uint8_t a = m->registers[REG_A];
+    uint16_t result = a + value + carry;
+    resultFlags8080(m, result, a ^ value ^ result);
+    m->registers[REG_A] = result;
+}
+
+static inline uint8_t subtract8080(Machine8080 *m, uint8_t value, int borrow)
+{
+    uint8_t a = m->registers[REG_A];
+    uint16_t result = a - value - borrow;
+    resultFlags8080(m, result & 0x1FF, ~(a ^ value ^ result));
+    return result;
+}
+
+static inline void and8080(Machine8080 *m, uint8_t value)
+{
+    uint8_t a = m->registers[REG_A];
+    m->registers[REG_A] = a & value;
+    resultFlags8080(m, a & value, (a | value) << 1);
+}
+
+static inline void xor8080(Machine8080 *m, uint8_t value)
+{
+    m->registers[REG_A] ^= value;
+    resultFlags8080(m, m->registers[REG_A], 0);
+}
+
+static inline void or8080(Machine8080 *m, uint8_t value)
+{
+    m->registers[REG_A] |= value;
+    resultFlags8080(m, m->registers[REG_A], 0);
+}
+
+static inline uint8_t increment8080(Machine8080 *m, uint8_t value)
+{
+    uint8_t result = value + 1;
+    stepFlags8080(m, result, value ^ 1 ^ result);
+    return result;
+}
+
+static inline uint8_t decrement8080(Machine8080 *m, uint8_t value)
+{
+    uint8_t result = value - 1;
+    stepFlags8080(m, result, ~(value ^ 1 ^ result));
+    return result;
+}
+
+
+// Instruction handlers, one per opcode kind. They are static inline so that the
+// computed-goto loop gets them inlined while the function-pointer table wraps them.
+#define HANDLER8080(name) static inline void op_##name(Machine8080 *m, const uint8_t *instruction, const Dispatch8080 *e)
+#define CARRY8080 carry8080(m)
+
+HANDLER8080(NOP) { }
+HANDLER8080(LXI) { setPair8080(m, e->dst, immediate8080(instruction)); }
+HANDLER8080(STAX) { writeMemory8080(m, getPair8080(m, e->dst), m->registers[REG_A]); }
+HANDLER8080(LDAX) { m->registers[REG_A] = readMemory8080(m, getPair8080(m, e->dst)); }
+HANDLER8080(SHLD)
+{
+    uint16_t address = immediate8080(instruction);
+    writeMemory8080(m, address, m->registers[5]);         // L
+    writeMemory8080(m, address + 1, m->registers[4]);     // H
+}
+HANDLER8080(LHLD)
+{
+    uint16_t address = immediate8080(instruction);
+    m->registers[5] = readMemory8080(m, address);         // L
+    m->registers[4] = readMemory8080(m, address + 1);     // H
+}
+HANDLER8080(STA) { writeMemory8080(m, immediate8080(instruction), m->registers[REG_A]); }
+HANDLER8080(LDA) { m->registers[REG_A] = readMemory8080(m, immediate8080(instruction)); }
+HANDLER8080(INX) { setPair8080(m, e->dst, getPair8080(m, e->dst) + 1); }
+HANDLER8080(DCX) { setPair8080(m, e->dst, getPair8080(m, e->dst) - 1); }
+HANDLER8080(DAD)
+{
+    uint32_t result = (uint32_t) getPair8080(m, 2) + getPair8080(m, e->dst);
+    setCarry8080(m, result >> 16);
+    setPair8080(m, 2, result);
+}
+HANDLER8080(INR) { m->registers[e->dst] = increment8080(m, m->registers[e->dst]); }
+HANDLER8080(DCR) { m->registers[e->dst] = decrement8080(m, m->registers[e->dst]); }
+HANDLER8080(INR_M) { uint16_t address = hl8080(m); writeMemory8080(m, address, increment8080(m, readMemory8080(m, address))); }
+HANDLER8080(DCR_M) { uint16_t address = hl8080(m); writeMemory8080(m, address, decrement8080(m, readMemory8080(m, address))); }
+HANDLER8080(MVI) { m->registers[e->dst] = instruction[1]; }
+HANDLER8080(MVI_M) { writeMemory8080(m, hl8080(m), instruction[1]); }
+HANDLER8080(RLC)
+{
+    uint8_t a = m->registers[REG_A];
+    setCarry8080(m, a >> 7);
+    m->registers[REG_A] = (a << 1) | (a >> 7);
+}
+HANDLER8080(RRC)
+{
+    uint8_t a = m->registers[REG_A];
+    setCarry8080(m, a & 1);
+    m->registers[REG_A] = (a >> 1) | (a << 7);
+}
+HANDLER8080(RAL)
+{
+    uint8_t a = m->registers[REG_A];
+    m->registers[REG_A] = (a << 1) | CARRY8080;
+    setCarry8080(m, a >> 7);
+}
+HANDLER8080(RAR)
+{
+    uint8_t a = m->registers[REG_A];
+    m->registers[REG_A] = (a >> 1) | (CARRY8080 << 7);
+    setCarry8080(m, a & 1);
+}
+HANDLER8080(DAA)
+{
+    uint8_t a = m->registers[REG_A];
+    uint8_t flags = getFlags8080(m);
+    uint8_t correction = 0;
+    int carry = flags & FLAG_CY;
+    if ((flags & FLAG_AC) || (a & 0x0F) > 9) correction |= 0x06;
+    if (carry || (a >> 4) > 9 || ((a >> 4) >= 9 && (a & 0x0F) > 9))
+    {
+        correction |= 0x60;
+        carry = 1;
+    }
+    add8080(m, correction, 0);
+    setCarry8080(m, carry);
+}
+HANDLER8080(CMA) { m->registers[REG_A] = ~m->registers[REG_A]; }
+HANDLER8080(STC) { setCarry8080(m, 1); }
+HANDLER8080(CMC) { setCarry8080(m, !CARRY8080); }
+HANDLER8080(MOV) { m->registers[e->dst] = m->registers[e->src]; }
+HANDLER8080(MOV_RM) { m->registers[e->dst] = readMemory8080(m, hl8080(m)); }
+HANDLER8080(MOV_MR) { writeMemory8080(m, hl8080(m), m->registers[e->src]); }
+// HLT: stay on the instruction until an interrupt arrives
+HANDLER8080(HLT)
+{
+    m->halted = 1;
+    m->pc--;
+    if (m->idleSkip) idleHalt8080(m);
+}
+HANDLER8080(ADD) { add8080(m, m->registers[e->src], 0); }
+HANDLER8080(ADC) { add8080(m, m->registers[e->src], CARRY8080); }
+HANDLER8080(SUB) { m->registers[REG_A] = subtract8080(m, m->registers[e->src], 0); }
+HANDLER8080(SBB) { m->registers[REG_A] = subtract8080(m, m->registers[e->src], CARRY8080); }
+HANDLER8080(ANA) { and8080(m, m->registers[e->src]); }
+HANDLER8080(XRA) { xor8080(m, m->registers[e->src]); }
+HANDLER8080(ORA) { or8080(m, m->registers[e->src]); }
+HANDLER8080(CMP) { subtract8080(m, m->registers[e->src], 0); }
+HANDLER8080(ADD_M) { add8080(m, readMemory8080(m, hl8080(m)), 0); }
+HANDLER8080(ADC_M) { add8080(m, readMemory8080(m, hl8080(m)), CARRY8080); }
+HANDLER8080(SUB_M) { m->registers[REG_A] = subtract8080(m, readMemory8080(m, hl8080(m)), 0); }
+HANDLER8080(SBB_M) { m->registers[REG_A] = subtract8080(m, readMemory8080(m, hl8080(m)), CARRY8080); }
+HANDLER8080(ANA_M) { and8080(m, readMemory8080(m, hl8080(m))); }
+HANDLER8080(XRA_M) { xor8080(m, readMemory8080(m, hl8080(m))); }
+HANDLER8080(ORA_M) { or8080(m, readMemory8080(m, hl8080(m))); }
+HANDLER8080(CMP_M) { subtract8080(m, readMemory8080(m, hl8080(m)), 0); }
+HANDLER8080(ADI) { add8080(m, instruction[1], 0); }
+HANDLER8080(ACI) { add8080(m, instruction[1], CARRY8080); }
+HANDLER8080(SUI) { m->registers[REG_A] = subtract8080(m, instruction[1], 0); }
+HANDLER8080(SBI) { m->registers[REG_A] = subtract8080(m, instruction[1], CARRY8080); }
+HANDLER8080(ANI) { and8080(m, instruction[1]); }
+HANDLER8080(XRI) { xor8080(m, instruction[1]); }
+HANDLER8080(ORI) { or8080(m, instruction[1]); }
+HANDLER8080(CPI) { subtract8080(m, instruction[1], 0); }
+HANDLER8080(RCC)
+{
+    if (condition8080(m, e->dst))
+    {
+        m->pc = pop8080(m);
+        m->cycles += e->cyclesTaken - e->cycles;
+    }
+}
+HANDLER8080(RET) { m->pc = pop8080(m); }
+HANDLER8080(POP) { setPair8080(m, e->dst, pop8080(m)); }
+HANDLER8080(POP_PSW)
+{
+    uint16_t psw = pop8080(m);
+    setFlags8080(m, psw);
+    m->registers[REG_A] = psw >> 8;
+}
+// Taken jumps back over a few bytes may close an idle loop
+static inline void jump8080(Machine8080 *m, uint16_t target)
+{
+    uint16_t next = m->pc;
+
+    m->pc = target;
+    if (m->idleSkip && (uint16_t) (next - 3 - target) < IDLE_LOOP_BYTES8080) idleLoop8080(m, next - 3);
+}
+
+HANDLER8080(JCC) { if (condition8080(m, e->dst)) jump8080(m, immediate8080(instruction)); }
+HANDLER8080(JMP) { jump8080(m, immediate8080(instruction)); }
+HANDLER8080(OUT) { portOut8080(m, instruction[1], m->registers[REG_A]); }
+HANDLER8080(IN) { m->registers[REG_A] = portIn8080(m, instruction[1]); }
+HANDLER8080(XTHL)
+{
+    uint8_t l = readMemory8080(m, m->SP);
+    uint8_t h = readMemory8080(m, m->SP + 1);
+    writeMemory8080(m, m->SP, m->registers[5]);
+    writeMemory8080(m, m->SP + 1, m->registers[4]);
+    m->registers[5] = l;
+    m->registers[4] = h;
+}
+HANDLER8080(PCHL) { m->pc = hl8080(m); }
+HANDLER8080(SPHL) { m->SP = hl8080(m); }
+HANDLER8080(XCHG)
+{
+    uint16_t de = getPair8080(m, 1);
+    setPair8080(m, 1, getPair8080(m, 2));
+    setPair8080(m, 2, de);
+}
+HANDLER8080(DI) { m->interruptsEnabled = 0; }
+// EI takes effect after the next instruction; a pending interrupt is taken there,
+// so the run ends after it
+HANDLER8080(EI)
+{
+    m->interruptsEnabled = 1;
+    if (m->pendingInterrupt >= 0 && m->target > m->cycles + 1) m->target = m->cycles + 1;
+}
+HANDLER8080(CCC)
+{
+    if (condition8080(m, e->dst))
+    {
+        push8080(m, m->pc);
+        m->pc = immediate8080(instruction);
+        m->cycles += e->cyclesTaken - e->cycles;
+    }
+}
+HANDLER8080(CALL)
+{
+    push8080(m, m->pc);
+    m->pc = immediate8080(instruction);
+}
+HANDLER8080(PUSH) { push8080(m, getPair8080(m, e->dst)); }
+// Bit 1 of the flag byte always reads as 1
+HANDLER8080(PUSH_PSW) { push8080(m, ((uint16_t) m->registers[REG_A] << 8) | getFlags8080(m) | 0x02); }
+HANDLER8080(RST)
+{
+    push8080(m, m->pc);
+    m->pc = e->dst << 3;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#include <string.h>
+
+#include "io8080.h"
+
+
+void initBus8080(IoBus8080 *bus)
+{
+    memset(bus, 0, sizeof(*bus));
+}
+
+void attachDevice8080(IoBus8080 *bus, uint8_t first, int count, PortIn8080 in, PortOut8080 out, void *device)
+{
+    for (int port = first; port < first + count && port < 256; port++)
+    {
+        if (in != NULL)
+        {
+            bus->in[port] = in;
+            bus->inDevices[port] = device;
+        }
+        if (out != NULL)
+        {
+            bus->out[port] = out;
+            bus->outDevices[port] = device;
+        }
+    }
+}
+
+void detachDevice8080(IoBus8080 *bus, uint8_t first, int count)
+{
+    for (int port = first; port < first + count && port < 256; port++)
+    {
+        bus->in[port] = NULL;
+        bus->out[port] = NULL;
+        bus->inDevices[port] = NULL;
+        bus->outDevices[port] = NULL;
+    }
+}
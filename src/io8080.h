@@ -0,0 +1,69 @@
+#ifndef IO8080_H
+#define IO8080_H
+
+#include <stdint.h>
+
+#include "cpu8080.h"
+
+// Port-mapped I/O. IN and OUT look their port up in a 256-entry handler table
+// per direction, where boards and other ROMs attach their devices. Ports with no
+// device attached belong to the Space Invaders board, which is handled inline
+// without an indirect call since its shift register is used on every sprite draw:
+//   IN 1, IN 2: m->input (buttons and DIP switches)
+//   IN 3:       the shift register, read shiftOffset bits below its top byte
+//   OUT 2:      set shiftOffset
+//   OUT 4:      shift a byte in from the top
+// Any other port reads 0 and ignores writes (sound and watchdog included). Every
+// access is counted per port in m->portReads and m->portWrites.
+
+typedef uint8_t (*PortIn8080)(void *device, Machine8080 *m, uint8_t port);
+typedef void (*PortOut8080)(void *device, Machine8080 *m, uint8_t port, uint8_t value);
+
+struct IoBus8080
+{
+    PortIn8080 in[256];
+    PortOut8080 out[256];
+    void *inDevices[256];
+    void *outDevices[256];
+};
+
+// Empty bus, every port left to the Invaders board
+void initBus8080(IoBus8080 *bus);
+// Attach a device to count ports from first. A NULL in or out handler leaves
+// that direction of the ports with whatever had them.
+void attachDevice8080(IoBus8080 *bus, uint8_t first, int count, PortIn8080 in, PortOut8080 out, void *device);
+// Hand count ports from first back to the Invaders board in both directions
+void detachDevice8080(IoBus8080 *bus, uint8_t first, int count);
+
+static inline uint8_t portIn8080(Machine8080 *m, uint8_t port)
+{
+    m->portReads[port]++;
+    if (m->bus != NULL && m->bus->in[port] != NULL) return m->bus->in[port](m->bus->inDevices[port], m, port);
+
+    switch (port)
+    {
+        case 1: return m->input[0];
+        case 2: return m->input[1];
+        case 3: return m->shift >> (8 - m->shiftOffset);
+        default: return 0;
+    }
+}
+
+static inline void portOut8080(Machine8080 *m, uint8_t port, uint8_t value)
+{
+    m->portWrites[port]++;
+    if (m->bus != NULL && m->bus->out[port] != NULL)
+    {
+        m->bus->out[port](m->bus->outDevices[port], m, port, value);
+        return;
+    }
+
+    switch (port)
+    {
+        case 2: m->shiftOffset = value & 7; break;
+        case 4: m->shift = (m->shift >> 8) | ((uint16_t) value << 8); break;
+        default: break;
+    }
+}
+
+#endif
@@ -0,0 +1,288 @@
+#include <string.h>
+
+#include "handlers8080.h"
+#include "lanes8080.h"
+#include "schedule8080.h"
+
+// One byte per lane; GCC lowers operations on it to AVX2, SSE2 or scalar code
+typedef uint8_t Vector8080 __attribute__((vector_size(LANES_MAX8080)));
+
+// Opcodes executed as vector code
+static uint8_t vectorOpcodes8080[256];
+
+
+void initLanes8080(void)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        switch (opcodes8080[i].kind)
+        {
+            case OP_NOP: case OP_MOV: case OP_MVI: case OP_INR: case OP_DCR:
+            case OP_ADD: case OP_ADC: case OP_SUB: case OP_SBB: case OP_ANA: case OP_XRA: case OP_ORA: case OP_CMP:
+            case OP_ADI: case OP_ACI: case OP_SUI: case OP_SBI: case OP_ANI: case OP_XRI: case OP_ORI: case OP_CPI:
+            case OP_CMA: case OP_STC: case OP_CMC:
+                vectorOpcodes8080[i] = 1;
+                break;
+            default:
+                vectorOpcodes8080[i] = 0;
+                break;
+        }
+    }
+}
+
+// Lane state <-> the lane's machine, around scalar steps and interrupts
+static void toMachine8080(Lanes8080 *lanes, int lane)
+{
+    Machine8080 *m = lanes->machines[lane];
+    for (int r = 0; r < 8; r++) m->registers[r] = lanes->registers[r][lane];
+    setFlags8080(m, lanes->flags[lane]);
+    m->SP = lanes->sp[lane];
+    m->pc = lanes->pc[lane];
+    m->cycles = lanes->cycles[lane];
+    m->instructions = lanes->instructions[lane];
+}
+
+static void fromMachine8080(Lanes8080 *lanes, int lane)
+{
+    Machine8080 *m = lanes->machines[lane];
+    for (int r = 0; r < 8; r++) lanes->registers[r][lane] = m->registers[r];
+    lanes->flags[lane] = getFlags8080(m);
+    lanes->sp[lane] = m->SP;
+    lanes->pc[lane] = m->pc;
+    lanes->cycles[lane] = m->cycles;
+    lanes->instructions[lane] = m->instructions;
+}
+
+void loadLanes8080(Lanes8080 *lanes, Machine8080 **machines, int count)
+{
+    memset(lanes, 0, sizeof(*lanes));
+    lanes->count = count;
+    for (int lane = 0; lane < count; lane++)
+    {
+        lanes->machines[lane] = machines[lane];
+        fromMachine8080(lanes, lane);
+    }
+}
+
+void storeLanes8080(Lanes8080 *lanes)
+{
+    for (int lane = 0; lane < lanes->count; lane++) toMachine8080(lanes, lane);
+}
+
+
+// Lane-wise equivalents of the flag helpers in handlers8080.h. Macros rather than
+// functions, since 32-byte vector arguments have a different ABI with and without AVX.
+#define SZP8080(r, parity) \
+    (parity = (r) ^ ((r) >> 4), parity ^= parity >> 2, parity ^= parity >> 1, \
+     ((r) & FLAG_S) | ((Vector8080) ((r) == 0) & FLAG_Z) | ((~parity & 1) << 2))
+
+#define ADD8080(r, flags, a, value, carry) \
+    { \
+        Vector8080 sum = (a) + (value), parity; \
+        r = sum + (carry); \
+        flags = SZP8080(r, parity) | (((a) ^ (value) ^ r) & FLAG_AC) | \
+                (((Vector8080) (sum < (a)) | (Vector8080) (r < sum)) & FLAG_CY); \
+    }
+
+#define SUBTRACT8080(r, flags, a, value, borrow) \
+    { \
+        Vector8080 difference = (a) - (value), parity; \
+        r = difference - (borrow); \
+        flags = SZP8080(r, parity) | (~((a) ^ (value) ^ r) & FLAG_AC) | \
+                (((Vector8080) ((a) < (value)) | (Vector8080) (difference < (borrow))) & FLAG_CY); \
+    }
+
+// Execute one instruction on the lanes selected by laneMask (0xFF per lane)
+__attribute__((target_clones("avx2", "default")))
+static void vectorStep8080(Lanes8080 *lanes, const uint8_t *laneMask, const uint8_t *instruction, const Dispatch8080 *e)
+{
+    Vector8080 mask = *(const Vector8080 *) laneMask;
+    Vector8080 *registers = (Vector8080 *) lanes->registers;
+    Vector8080 *flagsOut = (Vector8080 *) lanes->flags;
+    Vector8080 a = registers[REG_A];
+    Vector8080 flags = *flagsOut;
+    Vector8080 carry = flags & FLAG_CY;
+    Vector8080 immediate = (Vector8080) {} + instruction[1];
+    Vector8080 value = e->kind >= OP_ADI && e->kind <= OP_CPI ? immediate : registers[e->src];
+    Vector8080 zero = {};
+    Vector8080 one = zero + 1;
+    Vector8080 newFlags = flags;
+    Vector8080 result = a;
+    Vector8080 parity;
+    int dst = REG_A;
+
+    switch (e->kind)
+    {
+        case OP_NOP: return;
+        case OP_MOV: dst = e->dst; result = registers[e->src]; break;
+        case OP_MVI: dst = e->dst; result = immediate; break;
+        // INR and DCR leave CY alone
+        case OP_INR:
+            dst = e->dst;
+            ADD8080(result, newFlags, registers[dst], one, zero);
+            newFlags = (newFlags & ~FLAG_CY) | carry;
+            break;
+        case OP_DCR:
+            dst = e->dst;
+            SUBTRACT8080(result, newFlags, registers[dst], one, zero);
+            newFlags = (newFlags & ~FLAG_CY) | carry;
+            break;
+        case OP_ADD: case OP_ADI: ADD8080(result, newFlags, a, value, zero); break;
+        case OP_ADC: case OP_ACI: ADD8080(result, newFlags, a, value, carry); break;
+        case OP_SUB: case OP_SUI: SUBTRACT8080(result, newFlags, a, value, zero); break;
+        case OP_SBB: case OP_SBI: SUBTRACT8080(result, newFlags, a, value, carry); break;
+        case OP_CMP: case OP_CPI:
+        {
+            Vector8080 discard;
+            SUBTRACT8080(discard, newFlags, a, value, zero);
+            break;
+        }
+        case OP_ANA: case OP_ANI:
+            result = a & value;
+            newFlags = SZP8080(result, parity) | (((a | value) << 1) & FLAG_AC);
+            break;
+        case OP_XRA: case OP_XRI: result = a ^ value; newFlags = SZP8080(result, parity); break;
+        case OP_ORA: case OP_ORI: result = a | value; newFlags = SZP8080(result, parity); break;
+        case OP_CMA: result = ~a; break;
+        case OP_STC: newFlags = flags | FLAG_CY; break;
+        case OP_CMC: newFlags = flags ^ FLAG_CY; break;
+        default: return;
+    }
+
+    registers[dst] = (result & mask) | (registers[dst] & ~mask);
+    *flagsOut = (newFlags & mask) | (flags & ~mask);
+}
+
+// Run one lane on its machine until it reaches a vector instruction again. A
+// threaded loop like runGoto8080, with the handlers inlined.
+static void scalarRun8080(Lanes8080 *lanes, int lane, uint64_t *target)
+{
+    #define LABELADDRESS8080(name) &&label_##name,
+    static void *const labels[OP_KIND_COUNT] = { OPKINDS8080(LABELADDRESS8080) };
+    #undef LABELADDRESS8080
+    Machine8080 *m = lanes->machines[lane];
+    const uint8_t *instruction;
+    const Dispatch8080 *e;
+    uint64_t instructions = 0;
+
+    toMachine8080(lanes, lane);
+    m->target = *target;
+
+    // The first instruction is known not to be a vector one
+    #define STEP8080() \
+        instruction = &m->memory[m->pc]; \
+        e = &dispatch8080[*instruction]; \
+        m->pc += e->length; \
+        m->cycles += e->cycles; \
+        instructions++; \
+        goto *labels[e->kind]
+
+    #define NEXT8080() \
+        if (m->cycles >= m->target || vectorOpcodes8080[m->memory[m->pc]]) goto done; \
+        STEP8080()
+
+    STEP8080();
+
+    #define LABELBODY8080(name) label_##name: op_##name(m, instruction, e); NEXT8080();
+    OPKINDS8080(LABELBODY8080)
+    #undef LABELBODY8080
+    #undef NEXT8080
+    #undef STEP8080
+
+done:
+    m->instructions += instructions;
+    lanes->scalarLanes += instructions;
+    *target = m->target;
+    fromMachine8080(lanes, lane);
+}
+
+void runLanes8080(Lanes8080 *lanes, uint64_t *targets)
+{
+    uint8_t laneMask[LANES_MAX8080] __attribute__((aligned(32)));
+
+    for (;;)
+    {
+        // The lane furthest behind goes next, so lanes that took different paths
+        // meet up again on the same instruction
+        int leader = -1;
+        for (int lane = 0; lane < lanes->count; lane++)
+        {
+            if (lanes->cycles[lane] < targets[lane] && (leader < 0 || lanes->cycles[lane] < lanes->cycles[leader])) leader = lane;
+        }
+        if (leader < 0) break;
+
+        // Every unfinished lane on the same instruction bytes takes part
+        uint16_t pc = lanes->pc[leader];
+        const uint8_t *instruction = &lanes->machines[leader]->memory[pc];
+        int taking = 0;
+        memset(laneMask, 0, sizeof(laneMask));
+        for (int lane = 0; lane < lanes->count; lane++)
+        {
+            const uint8_t *bytes = &lanes->machines[lane]->memory[pc];
+            if (lanes->pc[lane] == pc && lanes->cycles[lane] < targets[lane] && bytes[0] == instruction[0] && bytes[1] == instruction[1])
+            {
+                laneMask[lane] = 0xFF;
+                taking++;
+            }
+        }
+
+        if (!vectorOpcodes8080[instruction[0]])
+        {
+            for (int lane = 0; lane < lanes->count; lane++)
+            {
+                if (laneMask[lane]) scalarRun8080(lanes, lane, &targets[lane]);
+            }
+            continue;
+        }
+
+        const Dispatch8080 *e = &dispatch8080[instruction[0]];
+        vectorStep8080(lanes, laneMask, instruction, e);
+
+        for (int lane = 0; lane < lanes->count; lane++)
+        {
+            if (!laneMask[lane]) continue;
+            lanes->pc[lane] = pc + e->length;
+            lanes->cycles[lane] += e->cycles;
+            lanes->instructions[lane]++;
+        }
+        lanes->vectorSteps++;
+        lanes->vectorLanes += taking;
+    }
+}
+
+void runLanesFrame8080(Lanes8080 *lanes)
+{
+    uint64_t frameEnd[LANES_MAX8080];
+    uint64_t deadlines[LANES_MAX8080];
+    int done[LANES_MAX8080];
+
+    // Same frame boundaries as runFrame8080, worked out per lane
+    for (int lane = 0; lane < lanes->count; lane++)
+    {
+        frameEnd[lane] = (lanes->cycles[lane] / FRAME_CYCLES8080 + 1) * FRAME_CYCLES8080;
+        done[lane] = 0;
+    }
+
+    // Every lane runs to its own next event, then the lanes that got there run
+    // their events, until each has run the event ending its frame
+    for (;;)
+    {
+        int running = 0;
+        for (int lane = 0; lane < lanes->count; lane++)
+        {
+            deadlines[lane] = done[lane] ? 0 : nextEvent8080(lanes->machines[lane], frameEnd[lane]);
+            running |= !done[lane];
+        }
+        if (!running) break;
+
+        runLanes8080(lanes, deadlines);
+        for (int lane = 0; lane < lanes->count; lane++)
+        {
+            if (done[lane]) continue;
+            toMachine8080(lanes, lane);
+            runEvents8080(lanes->machines[lane]);
+            fromMachine8080(lanes, lane);
+            done[lane] = lanes->cycles[lane] >= frameEnd[lane];
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef LANES8080_H
+#define LANES8080_H
+
+#include <stdint.h>
+
+#include "cpu8080.h"
+
+// Lockstep execution of up to LANES_MAX8080 machines. Their registers, flags, SP
+// and PC are kept in structure-of-arrays form, one array per register with one
+// element per lane. Every step picks the lane furthest behind and executes its
+// instruction on all lanes sitting on the same instruction: MOV, MVI and the
+// register and immediate ALU operations run as vector code across those lanes,
+// everything else runs scalar on the lane's own Machine8080 until it reaches
+// one of those again. Lanes that branch apart are scheduled separately and join
+// up again as soon as they are back on the same instruction. Each lane ends up
+// in exactly the state runFrame8080 would have left its machine in.
+
+#define LANES_MAX8080 32
+
+typedef struct
+{
+    int count;                                          // Lanes in use: 8, 16 or 32
+    Machine8080 *machines[LANES_MAX8080];               // Memory, and the scalar step
+    _Alignas(32) uint8_t registers[8][LANES_MAX8080];   // B, C, D, E, H, L, unused, A
+    _Alignas(32) uint8_t flags[LANES_MAX8080];          // Flag byte, kept eagerly
+    _Alignas(32) uint16_t sp[LANES_MAX8080];
+    _Alignas(32) uint16_t pc[LANES_MAX8080];
+    uint64_t cycles[LANES_MAX8080];
+    uint64_t instructions[LANES_MAX8080];
+
+    uint64_t vectorSteps;       // Instructions executed as vector code
+    uint64_t vectorLanes;       // Lane-instructions those covered
+    uint64_t scalarLanes;       // Lane-instructions executed one lane at a time
+} Lanes8080;
+
+// Build the table of opcodes run as vector code; must be called once before any
+// lanes are loaded, and before starting threads that load them
+void initLanes8080(void);
+// Take over count machines, copying their registers into the lanes
+void loadLanes8080(Lanes8080 *lanes, Machine8080 **machines, int count);
+// Copy the lane state back into the machines
+void storeLanes8080(Lanes8080 *lanes);
+
+// Run every lane until its cycle count reaches targets[lane]. A lane whose
+// machine lowers m->target, as EI does to take a pending interrupt, stops there
+// and has targets[lane] lowered to match.
+void runLanes8080(Lanes8080 *lanes, uint64_t *targets);
+// One video frame on every lane, with the same events and interrupts as runFrame8080
+void runLanesFrame8080(Lanes8080 *lanes);
+
+#endif
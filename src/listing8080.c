@@ -0,0 +1,239 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "listing8080.h"
+#include "opcodes8080.h"
+#include "pool8080.h"
+
+static const char hexDigits8080[] = "0123456789ABCDEF";
+
+// Everything of a line that depends only on the opcode: the mnemonic with the
+// separator and '$' of its operand, padded so it can be copied at a fixed size
+typedef struct
+{
+    char text[16];
+    uint8_t length;
+    uint8_t bytes;              // Instruction length
+} Template8080;
+
+static Template8080 templates8080[256];
+static char hexPairs8080[256][2];
+static pthread_once_t templatesOnce8080 = PTHREAD_ONCE_INIT;
+
+// One chunk of a window of the image being listed in parallel. Chunks are cut at
+// fixed offsets first; an instruction can straddle the cut, so the chunk really
+// starts up to two bytes later, depending on where the previous one ended.
+typedef struct
+{
+    size_t start;
+    size_t end;
+    size_t exits[3];            // Where the chunk ends if it starts 0, 1 or 2 bytes late
+    char *out;
+    size_t length;
+} Chunk8080;
+
+typedef struct
+{
+    const uint8_t *image;
+    size_t size;
+    Chunk8080 *chunks;
+} Window8080;
+
+
+static void initTemplates8080(void)
+{
+    for (int opcode = 0; opcode < 256; opcode++)
+    {
+        const Opcode8080 *op = &opcodes8080[opcode];
+        Template8080 *t = &templates8080[opcode];
+        size_t length = strlen(op->mnemonic);
+
+        memcpy(t->text, op->mnemonic, length);
+        if (op->length > 1)
+        {
+            if (op->mnemonic[length - 1] != ',') t->text[length++] = ' ';
+            t->text[length++] = '$';
+        }
+        t->length = length;
+        t->bytes = op->length;
+
+        hexPairs8080[opcode][0] = hexDigits8080[opcode >> 4];
+        hexPairs8080[opcode][1] = hexDigits8080[opcode & 15];
+    }
+}
+
+static inline char *putHex8080(char *out, uint8_t value)
+{
+    memcpy(out, hexPairs8080[value], 2);
+    return out + 2;
+}
+
+size_t formatListing8080(const uint8_t *image, size_t size, size_t start, size_t end, char *out)
+{
+    char *p = out;
+    int wide = size > 0x10000;
+
+    pthread_once(&templatesOnce8080, initTemplates8080);
+
+    size_t address = start;
+    while (address < end && address < size)
+    {
+        const uint8_t *instruction = &image[address];
+        const Template8080 *t = &templates8080[instruction[0]];
+
+        if (wide)
+        {
+            p = putHex8080(p, address >> 24);
+            p = putHex8080(p, address >> 16);
+        }
+        p = putHex8080(p, address >> 8);
+        p = putHex8080(p, address);
+
+        // The last instructions may not have three bytes to read
+        if (address + 3 > size)
+        {
+            if (address + t->bytes > size)
+            {
+                memcpy(p, "  DB ", 5);
+                p += 5;
+                for (size_t i = address; i < size; i++)
+                {
+                    if (i > address) *p++ = ',';
+                    *p++ = '$';
+                    p = putHex8080(p, image[i]);
+                }
+                *p++ = '\n';
+                break;
+            }
+            uint8_t padded[3] = { instruction[0], 0, 0 };
+            memcpy(padded, instruction, size - address);
+            instruction = padded;
+        }
+
+        // Opcodes come in no predictable order, so the line is built without
+        // branching on the length: all three bytes are written, the columns past
+        // the instruction blanked again, and the operand digits always written
+        // with only as many kept as the instruction has
+        memcpy(p, "  ", 2);
+        putHex8080(p + 2, instruction[0]);
+        p[4] = ' ';
+        putHex8080(p + 5, instruction[1]);
+        p[7] = ' ';
+        putHex8080(p + 8, instruction[2]);
+        memcpy(p + 1 + 3 * t->bytes, "            ", 12);
+        p += 14;
+
+        memcpy(p, t->text, sizeof(t->text));
+        p += t->length;
+        putHex8080(p, instruction[t->bytes - 1]);
+        putHex8080(p + 2, instruction[1]);
+        p += 2 * (t->bytes - 1);
+        *p++ = '\n';
+
+        address += t->bytes;
+    }
+    return p - out;
+}
+
+// Find the first instruction boundary at or past the end of the chunk for each of
+// the three places it can start. Decoding from different offsets falls into step
+// within a few instructions, so the three paths are walked together, always
+// moving the one furthest behind, until they meet; from there one walk is enough.
+static void findExits8080(void *context, int task, int worker)
+{
+    Window8080 *window = context;
+    Chunk8080 *chunk = &window->chunks[task];
+    const uint8_t *image = window->image;
+    size_t limit = chunk->end;
+    size_t path[3] = { chunk->start, chunk->start + 1, chunk->start + 2 };
+
+    (void) worker;
+    while (path[0] != path[1] || path[1] != path[2])
+    {
+        int behind = path[1] < path[0] ? 1 : 0;
+        if (path[2] < path[behind]) behind = 2;
+        if (path[behind] >= limit) break;
+        path[behind] += opcodes8080[image[path[behind]]].length;
+    }
+    if (path[0] == path[1] && path[1] == path[2])
+    {
+        while (path[0] < limit) path[0] += opcodes8080[image[path[0]]].length;
+        path[1] = path[2] = path[0];
+    }
+    memcpy(chunk->exits, path, sizeof(path));
+}
+
+static void formatChunk8080(void *context, int task, int worker)
+{
+    Window8080 *window = context;
+    Chunk8080 *chunk = &window->chunks[task];
+
+    (void) worker;
+    chunk->length = formatListing8080(window->image, window->size, chunk->start, chunk->end, chunk->out);
+}
+
+static int runChunks8080(Window8080 *window, int used, int threads, Task8080 run)
+{
+    if (used == 1 || threads == 1)
+    {
+        for (int i = 0; i < used; i++) run(window, i, 0);
+        return 1;
+    }
+    return runPool8080(threads < used ? threads : used, used, run, window, NULL);
+}
+
+int writeListing8080(FILE *file, const uint8_t *image, size_t size, int threads)
+{
+    if (threads <= 0) threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0) threads = 1;
+
+    // A few chunks per worker keeps them all busy to the end of a window while
+    // bounding the memory the formatted text takes
+    int count = size <= LISTING_CHUNK8080 ? 1 : threads * 4;
+    size_t capacity = (size_t) LISTING_CHUNK8080 * LISTING_LINE_MAX8080 + 64;
+    Chunk8080 *chunks = calloc(count, sizeof(Chunk8080));
+    char *buffers = malloc(count * capacity);
+    if (chunks == NULL || buffers == NULL)
+    {
+        free(chunks);
+        free(buffers);
+        return 0;
+    }
+
+    Window8080 window = { image, size, chunks };
+    int ok = 1;
+    size_t address = 0;
+    while (ok && address < size)
+    {
+        int used = 0;
+        for (size_t cut = address; used < count && cut < size; cut += LISTING_CHUNK8080)
+        {
+            chunks[used].start = cut;
+            chunks[used].end = cut + LISTING_CHUNK8080 < size ? cut + LISTING_CHUNK8080 : size;
+            chunks[used].out = buffers + used * capacity;
+            used++;
+        }
+
+        // Find the exits in parallel, then chain the chunks together: each starts
+        // where the previous one really ended
+        ok = runChunks8080(&window, used, threads, findExits8080);
+        for (int i = 0; ok && i < used; i++)
+        {
+            chunks[i].end = chunks[i].exits[address - chunks[i].start];
+            chunks[i].start = address;
+            address = chunks[i].end;
+        }
+
+        ok = ok && runChunks8080(&window, used, threads, formatChunk8080);
+        for (int i = 0; ok && i < used; i++)
+        {
+            ok = fwrite(chunks[i].out, 1, chunks[i].length, file) == chunks[i].length;
+        }
+    }
+
+    free(chunks);
+    free(buffers);
+    return ok;
+}
@@ -0,0 +1,33 @@
+#ifndef LISTING8080_H
+#define LISTING8080_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Batch disassembly of large images. Instructions are decoded with the
+// opcodes8080 table the emulator runs from and formatted by hand into big
+// buffers, one line each:
+//   0003  C3 D4 18    JMP $18D4
+// Addresses take four digits for images up to 64 KiB and eight above that. A last
+// instruction cut short by the end of the image is listed as DB bytes.
+//
+// Images are cut into chunks at fixed offsets, moved to instruction boundaries
+// with a quick parallel pass over the opcode lengths, formatted in parallel on the
+// thread pool into buffers of their own and written out in order.
+
+// Most characters one line can take, plus slack for the fixed-size copies
+#define LISTING_LINE_MAX8080 48
+#define LISTING_CHUNK8080 (64 << 10)
+
+// Format the instructions starting from start, which must be an instruction
+// boundary, up to the first boundary at or after end. out needs room for
+// LISTING_LINE_MAX8080 characters per byte of the range. Returns the number of
+// characters written.
+size_t formatListing8080(const uint8_t *image, size_t size, size_t start, size_t end, char *out);
+
+// Write a listing of the whole image to file on threads workers (0: one per
+// core). Returns 0 if it could not allocate its buffers or a write failed.
+int writeListing8080(FILE *file, const uint8_t *image, size_t size, int threads);
+
+#endif
@@ -0,0 +1,174 @@
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "block8080.h"
+#include "memory8080.h"
+
+
+static inline uint16_t hostAddress8080(const Machine8080 *m, uint16_t address)
+{
+    return (uint16_t) (m->pageTargets[address >> 8] << 8) | (address & 0xFF);
+}
+
+static inline int cachedCode8080(const Machine8080 *m, int host)
+{
+    return (m->codePages[host >> 6] >> (host & 63)) & 1;
+}
+
+static void writeRom8080(Machine8080 *m, uint16_t address, uint8_t value)
+{
+    (void) address;
+    (void) value;
+    m->romWrites++;
+}
+
+static void writeRam8080(Machine8080 *m, uint16_t address, uint8_t value)
+{
+    uint16_t host = hostAddress8080(m, address);
+
+    m->memory[host] = value;
+    if (cachedCode8080(m, host >> 8)) invalidateCode8080(m, host);
+}
+
+static void writeVram8080(Machine8080 *m, uint16_t address, uint8_t value)
+{
+    uint16_t host = hostAddress8080(m, address);
+    uint16_t line = (uint16_t) (host - VRAM_START8080) / VRAM_COLUMN8080;
+
+    m->memory[host] = value;
+    m->vramDirty[line / 64] |= 1ULL << (line % 64);
+    if (cachedCode8080(m, host >> 8)) invalidateCode8080(m, host);
+}
+
+static const WritePage8080 writeKinds8080[] = { writeRam8080, writeRom8080, writeVram8080 };
+
+// Count and report the hits of every watchpoint on the same host address
+static void hitWatchpoints8080(Machine8080 *m, uint16_t address, uint8_t value, int flag)
+{
+    uint16_t host = hostAddress8080(m, address);
+
+    for (int i = 0; i < m->watchCount; i++)
+    {
+        Watchpoint8080 *w = &m->watchpoints[i];
+        if (!(w->flags & flag) || hostAddress8080(m, w->address) != host) continue;
+        w->hits++;
+        if (m->watchHit != NULL) m->watchHit(m, w, address, value, flag == WATCH_WRITE8080);
+    }
+}
+
+static uint8_t readWatch8080(Machine8080 *m, uint16_t address)
+{
+    uint8_t value = m->memory[hostAddress8080(m, address)];
+
+    hitWatchpoints8080(m, address, value, WATCH_READ8080);
+    return value;
+}
+
+static void writeWatch8080(Machine8080 *m, uint16_t address, uint8_t value)
+{
+    hitWatchpoints8080(m, address, value, WATCH_WRITE8080);
+    writeKinds8080[m->pageKinds[m->pageTargets[address >> 8]]](m, address, value);
+}
+
+// Watchpoint flags set on any address of host page
+static int watchedPage8080(const Machine8080 *m, int host)
+{
+    int flags = 0;
+
+    for (int i = 0; i < m->watchCount; i++)
+    {
+        if (hostAddress8080(m, m->watchpoints[i].address) >> 8 == host) flags |= m->watchpoints[i].flags;
+    }
+    return flags;
+}
+
+void remapPage8080(Machine8080 *m, int host)
+{
+    int watched = watchedPage8080(m, host);
+    int kind = m->pageKinds[host];
+    uint8_t *base = m->memory + (host << 8);
+    int direct = kind == PAGE_RAM8080 && !cachedCode8080(m, host) && !(watched & WATCH_WRITE8080);
+
+    for (int page = 0; page < 256; page++)
+    {
+        if (m->pageTargets[page] != host) continue;
+        m->readPages[page] = watched & WATCH_READ8080 ? NULL : base;
+        m->readHandlers[page] = readWatch8080;
+        m->writePages[page] = direct ? base : NULL;
+        m->writeHandlers[page] = watched & WATCH_WRITE8080 ? writeWatch8080 : writeKinds8080[kind];
+    }
+}
+
+// Map every host page of m->memory that mirrors another onto the pages it
+// mirrors, and give back pages of their own to the ones that mirrored something
+// before. The mirrors are recreated every time, as loading a ROM replaces the
+// pages they alias.
+static int aliasMirrors8080(Machine8080 *m, int decodedPages)
+{
+    size_t chunk = sysconf(_SC_PAGESIZE);
+    size_t decoded = (size_t) decodedPages << 8;
+    size_t mirrored = (size_t) (m->decodedPages ? m->decodedPages : 256) << 8;
+
+    if (decoded % chunk != 0) return 0;
+    for (size_t address = 0; address <= MEMORY_SIZE8080; address += chunk)
+    {
+        uint8_t *at = m->memory + address;
+        size_t target = address % decoded;
+        void *mapped;
+
+        if (target != address) mapped = mremap(m->memory + target, 0, chunk, MREMAP_MAYMOVE | MREMAP_FIXED, at);
+        else if (address % mirrored != address) mapped = mmap(at, chunk, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+        else continue;
+        if (mapped == MAP_FAILED) return 0;
+    }
+    m->decodedPages = decodedPages;
+    return 1;
+}
+
+int mapMemory8080(Machine8080 *m, int decodedPages)
+{
+    if (!aliasMirrors8080(m, decodedPages)) return 0;
+    for (int page = 0; page < 256; page++)
+    {
+        uint32_t address = page << 8;
+
+        m->pageTargets[page] = page % decodedPages;
+        if (address < m->romSize) m->pageKinds[page] = PAGE_ROM8080;
+        else if (address >= VRAM_START8080 && address < VRAM_START8080 + VRAM_SIZE8080) m->pageKinds[page] = PAGE_VRAM8080;
+        else m->pageKinds[page] = PAGE_RAM8080;
+    }
+    for (int host = 0; host < decodedPages; host++) remapPage8080(m, host);
+    return 1;
+}
+
+int watch8080(Machine8080 *m, uint16_t address, int flags)
+{
+    Watchpoint8080 *w = NULL;
+
+    for (int i = 0; i < m->watchCount; i++)
+    {
+        if (m->watchpoints[i].address == address) w = &m->watchpoints[i];
+    }
+    if (w == NULL)
+    {
+        if (m->watchCount == WATCHPOINTS8080) return 0;
+        w = &m->watchpoints[m->watchCount++];
+        *w = (Watchpoint8080) { address, 0, 0 };
+    }
+    w->flags |= flags;
+    remapPage8080(m, hostAddress8080(m, address) >> 8);
+    return 1;
+}
+
+void unwatch8080(Machine8080 *m, uint16_t address)
+{
+    for (int i = 0; i < m->watchCount; i++)
+    {
+        if (m->watchpoints[i].address != address) continue;
+        m->watchpoints[i] = m->watchpoints[--m->watchCount];
+        remapPage8080(m, hostAddress8080(m, address) >> 8);
+        return;
+    }
+}
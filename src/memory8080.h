@@ -0,0 +1,53 @@
+#ifndef MEMORY8080_H
+#define MEMORY8080_H
+
+#include <stdint.h>
+
+#include "cpu8080.h"
+
+// Memory map. The address space is 256 pages of 256 bytes; each page maps onto a
+// host page of m->memory, its own or the one it mirrors, and the host page has a
+// kind. Loads and stores look their page up in m->readPages and m->writePages:
+// an entry there is the host page to use directly, which is the common case and
+// costs a single indexed load. Pages without one go through their handler:
+//   ROM:        stores are ignored and counted in m->romWrites
+//   video RAM:  stores mark their line dirty
+//   RAM holding blocks in the block cache: stores drop those blocks
+//   watchpoint: the access is counted and reported, then handled as usual
+// Reads only need a handler on watched pages. A mirror needs no handler of its
+// own: its entries point at the host page it mirrors, and when that page takes a
+// handler the mirror takes the same one.
+//
+// Instruction fetch reads m->memory at the PC without the map, so a mirror is also
+// backed by the same physical pages as what it mirrors, aliased into m->memory
+// with mremap: code run from a mirror fetches exactly the bytes loads there see.
+// The spare page past 0xFFFF aliases the bottom of memory the same way.
+//
+// The map is flat with the ROM read-only until loadRom8080 maps the Invaders
+// board, whose address decoding ignores A14 and A15 so that 0x4000-0xFFFF mirror
+// 0x0000-0x3FFF four times over.
+
+enum
+{
+    PAGE_RAM8080,
+    PAGE_ROM8080,
+    PAGE_VRAM8080,
+};
+
+#define WATCH_READ8080 1
+#define WATCH_WRITE8080 2
+
+// Map pages 0 up to decodedPages onto themselves and mirror the rest of the
+// space onto them; pages under m->romSize are ROM. Returns 0 if the host cannot
+// alias the mirrors, when decodedPages does not span whole host pages.
+int mapMemory8080(Machine8080 *m, int decodedPages);
+// Rebuild the entries of every page mapped onto host page, after its kind, its
+// watchpoints or its cached code changed
+void remapPage8080(Machine8080 *m, int host);
+
+// Watch loads and/or stores of an address (and its mirrors). Returns 0 when every
+// watchpoint is taken.
+int watch8080(Machine8080 *m, uint16_t address, int flags);
+void unwatch8080(Machine8080 *m, uint16_t address);
+
+#endif
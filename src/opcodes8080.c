@@ -0,0 +1,262 @@
+#include "opcodes8080.h"
+
+// Undocumented opcodes (marked with '*') behave like the documented instruction they alias
+const Opcode8080 opcodes8080[256] =
+{
+    [0x00] = { "NOP",       OP_NOP,      1,  4,  4, 0, 0 },
+    [0x01] = { "LXI B,",    OP_LXI,      3, 10, 10, 0, 0 },
+    [0x02] = { "STAX B",    OP_STAX,     1,  7,  7, 0, 0 },
+    [0x03] = { "INX B",     OP_INX,      1,  5,  5, 0, 0 },
+    [0x04] = { "INR B",     OP_INR,      1,  5,  5, 0, 0 },
+    [0x05] = { "DCR B",     OP_DCR,      1,  5,  5, 0, 0 },
+    [0x06] = { "MVI B,",    OP_MVI,      2,  7,  7, 0, 0 },
+    [0x07] = { "RLC",       OP_RLC,      1,  4,  4, 0, 0 },
+    [0x08] = { "*NOP",      OP_NOP,      1,  4,  4, 0, 0 },
+    [0x09] = { "DAD B",     OP_DAD,      1, 10, 10, 0, 0 },
+    [0x0A] = { "LDAX B",    OP_LDAX,     1,  7,  7, 0, 0 },
+    [0x0B] = { "DCX B",     OP_DCX,      1,  5,  5, 0, 0 },
+    [0x0C] = { "INR C",     OP_INR,      1,  5,  5, 1, 0 },
+    [0x0D] = { "DCR C",     OP_DCR,      1,  5,  5, 1, 0 },
+    [0x0E] = { "MVI C,",    OP_MVI,      2,  7,  7, 1, 0 },
+    [0x0F] = { "RRC",       OP_RRC,      1,  4,  4, 0, 0 },
+    [0x10] = { "*NOP",      OP_NOP,      1,  4,  4, 0, 0 },
+    [0x11] = { "LXI D,",    OP_LXI,      3, 10, 10, 1, 0 },
+    [0x12] = { "STAX D",    OP_STAX,     1,  7,  7, 1, 0 },
+    [0x13] = { "INX D",     OP_INX,      1,  5,  5, 1, 0 },
+    [0x14] = { "INR D",     OP_INR,      1,  5,  5, 2, 0 },
+    [0x15] = { "DCR D",     OP_DCR,      1,  5,  5, 2, 0 },
+    [0x16] = { "MVI D,",    OP_MVI,      2,  7,  7, 2, 0 },
+    [0x17] = { "RAL",       OP_RAL,      1,  4,  4, 0, 0 },
+    [0x18] = { "*NOP",      OP_NOP,      1,  4,  4, 0, 0 },
+    [0x19] = { "DAD D",     OP_DAD,      1, 10, 10, 1, 0 },
+    [0x1A] = { "LDAX D",    OP_LDAX,     1,  7,  7, 1, 0 },
+    [0x1B] = { "DCX D",     OP_DCX,      1,  5,  5, 1, 0 },
+    [0x1C] = { "INR E",     OP_INR,      1,  5,  5, 3, 0 },
+    [0x1D] = { "DCR E",     OP_DCR,      1,  5,  5, 3, 0 },
+    [0x1E] = { "MVI E,",    OP_MVI,      2,  7,  7, 3, 0 },
+    [0x1F] = { "RAR",       OP_RAR,      1,  4,  4, 0, 0 },
+    [0x20] = { "*NOP",      OP_NOP,      1,  4,  4, 0, 0 },
+    [0x21] = { "LXI H,",    OP_LXI,      3, 10, 10, 2, 0 },
+    [0x22] = { "SHLD",      OP_SHLD,     3, 16, 16, 0, 0 },
+    [0x23] = { "INX H",     OP_INX,      1,  5,  5, 2, 0 },
+    [0x24] = { "INR H",     OP_INR,      1,  5,  5, 4, 0 },
+    [0x25] = { "DCR H",     OP_DCR,      1,  5,  5, 4, 0 },
+    [0x26] = { "MVI H,",    OP_MVI,      2,  7,  7, 4, 0 },
+    [0x27] = { "DAA",       OP_DAA,      1,  4,  4, 0, 0 },
+    [0x28] = { "*NOP",      OP_NOP,      1,  4,  4, 0, 0 },
+    [0x29] = { "DAD H",     OP_DAD,      1, 10, 10, 2, 0 },
+    [0x2A] = { "LHLD",      OP_LHLD,     3, 16, 16, 0, 0 },
+    [0x2B] = { "DCX H",     OP_DCX,      1,  5,  5, 2, 0 },
+    [0x2C] = { "INR L",     OP_INR,      1,  5,  5, 5, 0 },
+    [0x2D] = { "DCR L",     OP_DCR,      1,  5,  5, 5, 0 },
+    [0x2E] = { "MVI L,",    OP_MVI,      2,  7,  7, 5, 0 },
+    [0x2F] = { "CMA",       OP_CMA,      1,  4,  4, 0, 0 },
+    [0x30] = { "*NOP",      OP_NOP,      1,  4,  4, 0, 0 },
+    [0x31] = { "LXI SP,",   OP_LXI,      3, 10, 10, 3, 0 },
+    [0x32] = { "STA",       OP_STA,      3, 13, 13, 0, 0 },
+    [0x33] = { "INX SP",    OP_INX,      1,  5,  5, 3, 0 },
+    [0x34] = { "INR M",     OP_INR_M,    1, 10, 10, 0, 0 },
+    [0x35] = { "DCR M",     OP_DCR_M,    1, 10, 10, 0, 0 },
+    [0x36] = { "MVI M,",    OP_MVI_M,    2, 10, 10, 0, 0 },
+    [0x37] = { "STC",       OP_STC,      1,  4,  4, 0, 0 },
+    [0x38] = { "*NOP",      OP_NOP,      1,  4,  4, 0, 0 },
+    [0x39] = { "DAD SP",    OP_DAD,      1, 10, 10, 3, 0 },
+    [0x3A] = { "LDA",       OP_LDA,      3, 13, 13, 0, 0 },
+    [0x3B] = { "DCX SP",    OP_DCX,      1,  5,  5, 3, 0 },
+    [0x3C] = { "INR A",     OP_INR,      1,  5,  5, 7, 0 },
+    [0x3D] = { "DCR A",     OP_DCR,      1,  5,  5, 7, 0 },
+    [0x3E] = { "MVI A,",    OP_MVI,      2,  7,  7, 7, 0 },
+    [0x3F] = { "CMC",       OP_CMC,      1,  4,  4, 0, 0 },
+    [0x40] = { "MOV B,B",   OP_MOV,      1,  5,  5, 0, 0 },
+    [0x41] = { "MOV B,C",   OP_MOV,      1,  5,  5, 0, 1 },
+    [0x42] = { "MOV B,D",   OP_MOV,      1,  5,  5, 0, 2 },
+    [0x43] = { "MOV B,E",   OP_MOV,      1,  5,  5, 0, 3 },
+    [0x44] = { "MOV B,H",   OP_MOV,      1,  5,  5, 0, 4 },
+    [0x45] = { "MOV B,L",   OP_MOV,      1,  5,  5, 0, 5 },
+    [0x46] = { "MOV B,M",   OP_MOV_RM,   1,  7,  7, 0, 0 },
+    [0x47] = { "MOV B,A",   OP_MOV,      1,  5,  5, 0, 7 },
+    [0x48] = { "MOV C,B",   OP_MOV,      1,  5,  5, 1, 0 },
+    [0x49] = { "MOV C,C",   OP_MOV,      1,  5,  5, 1, 1 },
+    [0x4A] = { "MOV C,D",   OP_MOV,      1,  5,  5, 1, 2 },
+    [0x4B] = { "MOV C,E",   OP_MOV,      1,  5,  5, 1, 3 },
+    [0x4C] = { "MOV C,H",   OP_MOV,      1,  5,  5, 1, 4 },
+    [0x4D] = { "MOV C,L",   OP_MOV,      1,  5,  5, 1, 5 },
+    [0x4E] = { "MOV C,M",   OP_MOV_RM,   1,  7,  7, 1, 0 },
+    [0x4F] = { "MOV C,A",   OP_MOV,      1,  5,  5, 1, 7 },
+    [0x50] = { "MOV D,B",   OP_MOV,      1,  5,  5, 2, 0 },
+    [0x51] = { "MOV D,C",   OP_MOV,      1,  5,  5, 2, 1 },
+    [0x52] = { "MOV D,D",   OP_MOV,      1,  5,  5, 2, 2 },
+    [0x53] = { "MOV D,E",   OP_MOV,      1,  5,  5, 2, 3 },
+    [0x54] = { "MOV D,H",   OP_MOV,      1,  5,  5, 2, 4 },
+    [0x55] = { "MOV D,L",   OP_MOV,      1,  5,  5, 2, 5 },
+    [0x56] = { "MOV D,M",   OP_MOV_RM,   1,  7,  7, 2, 0 },
+    [0x57] = { "MOV D,A",   OP_MOV,      1,  5,  5, 2, 7 },
+    [0x58] = { "MOV E,B",   OP_MOV,      1,  5,  5, 3, 0 },
+    [0x59] = { "MOV E,C",   OP_MOV,      1,  5,  5, 3, 1 },
+    [0x5A] = { "MOV E,D",   OP_MOV,      1,  5,  5, 3, 2 },
+    [0x5B] = { "MOV E,E",   OP_MOV,      1,  5,  5, 3, 3 },
+    [0x5C] = { "MOV E,H",   OP_MOV,      1,  5,  5, 3, 4 },
+    [0x5D] = { "MOV E,L",   OP_MOV,      1,  5,  5, 3, 5 },
+    [0x5E] = { "MOV E,M",   OP_MOV_RM,   1,  7,  7, 3, 0 },
+    [0x5F] = { "MOV E,A",   OP_MOV,      1,  5,  5, 3, 7 },
+    [0x60] = { "MOV H,B",   OP_MOV,      1,  5,  5, 4, 0 },
+    [0x61] = { "MOV H,C",   OP_MOV,      1,  5,  5, 4, 1 },
+    [0x62] = { "MOV H,D",   OP_MOV,      1,  5,  5, 4, 2 },
+    [0x63] = { "MOV H,E",   OP_MOV,      1,  5,  5, 4, 3 },
+    [0x64] = { "MOV H,H",   OP_MOV,      1,  5,  5, 4, 4 },
+    [0x65] = { "MOV H,L",   OP_MOV,      1,  5,  5, 4, 5 },
+    [0x66] = { "MOV H,M",   OP_MOV_RM,   1,  7,  7, 4, 0 },
+    [0x67] = { "MOV H,A",   OP_MOV,      1,  5,  5, 4, 7 },
+    [0x68] = { "MOV L,B",   OP_MOV,      1,  5,  5, 5, 0 },
+    [0x69] = { "MOV L,C",   OP_MOV,      1,  5,  5, 5, 1 },
+    [0x6A] = { "MOV L,D",   OP_MOV,      1,  5,  5, 5, 2 },
+    [0x6B] = { "MOV L,E",   OP_MOV,      1,  5,  5, 5, 3 },
+    [0x6C] = { "MOV L,H",   OP_MOV,      1,  5,  5, 5, 4 },
+    [0x6D] = { "MOV L,L",   OP_MOV,      1,  5,  5, 5, 5 },
+    [0x6E] = { "MOV L,M",   OP_MOV_RM,   1,  7,  7, 5, 0 },
+    [0x6F] = { "MOV L,A",   OP_MOV,      1,  5,  5, 5, 7 },
+    [0x70] = { "MOV M,B",   OP_MOV_MR,   1,  7,  7, 0, 0 },
+    [0x71] = { "MOV M,C",   OP_MOV_MR,   1,  7,  7, 0, 1 },
+    [0x72] = { "MOV M,D",   OP_MOV_MR,   1,  7,  7, 0, 2 },
+    [0x73] = { "MOV M,E",   OP_MOV_MR,   1,  7,  7, 0, 3 },
+    [0x74] = { "MOV M,H",   OP_MOV_MR,   1,  7,  7, 0, 4 },
+    [0x75] = { "MOV M,L",   OP_MOV_MR,   1,  7,  7, 0, 5 },
+    [0x76] = { "HLT",       OP_HLT,      1,  7,  7, 0, 0 },
+    [0x77] = { "MOV M,A",   OP_MOV_MR,   1,  7,  7, 0, 7 },
+    [0x78] = { "MOV A,B",   OP_MOV,      1,  5,  5, 7, 0 },
+    [0x79] = { "MOV A,C",   OP_MOV,      1,  5,  5, 7, 1 },
+    [0x7A] = { "MOV A,D",   OP_MOV,      1,  5,  5, 7, 2 },
+    [0x7B] = { "MOV A,E",   OP_MOV,      1,  5,  5, 7, 3 },
+    [0x7C] = { "MOV A,H",   OP_MOV,      1,  5,  5, 7, 4 },
+    [0x7D] = { "MOV A,L",   OP_MOV,      1,  5,  5, 7, 5 },
+    [0x7E] = { "MOV A,M",   OP_MOV_RM,   1,  7,  7, 7, 0 },
+    [0x7F] = { "MOV A,A",   OP_MOV,      1,  5,  5, 7, 7 },
+    [0x80] = { "ADD B",     OP_ADD,      1,  4,  4, 0, 0 },
+    [0x81] = { "ADD C",     OP_ADD,      1,  4,  4, 0, 1 },
+    [0x82] = { "ADD D",     OP_ADD,      1,  4,  4, 0, 2 },
+    [0x83] = { "ADD E",     OP_ADD,      1,  4,  4, 0, 3 },
+    [0x84] = { "ADD H",     OP_ADD,      1,  4,  4, 0, 4 },
+    [0x85] = { "ADD L",     OP_ADD,      1,  4,  4, 0, 5 },
+    [0x86] = { "ADD M",     OP_ADD_M,    1,  7,  7, 0, 0 },
+    [0x87] = { "ADD A",     OP_ADD,      1,  4,  4, 0, 7 },
+    [0x88] = { "ADC B",     OP_ADC,      1,  4,  4, 0, 0 },
+    [0x89] = { "ADC C",     OP_ADC,      1,  4,  4, 0, 1 },
+    [0x8A] = { "ADC D",     OP_ADC,      1,  4,  4, 0, 2 },
+    [0x8B] = { "ADC E",     OP_ADC,      1,  4,  4, 0, 3 },
+    [0x8C] = { "ADC H",     OP_ADC,      1,  4,  4, 0, 4 },
+    [0x8D] = { "ADC L",     OP_ADC,      1,  4,  4, 0, 5 },
+    [0x8E] = { "ADC M",     OP_ADC_M,    1,  7,  7, 0, 0 },
+    [0x8F] = { "ADC A",     OP_ADC,      1,  4,  4, 0, 7 },
+    [0x90] = { "SUB B",     OP_SUB,      1,  4,  4, 0, 0 },
+    [0x91] = { "SUB C",     OP_SUB,      1,  4,  4, 0, 1 },
+    [0x92] = { "SUB D",     OP_SUB,      1,  4,  4, 0, 2 },
+    [0x93] = { "SUB E",     OP_SUB,      1,  4,  4, 0, 3 },
+    [0x94] = { "SUB H",     OP_SUB,      1,  4,  4, 0, 4 },
+    [0x95] = { "SUB L",     OP_SUB,      1,  4,  4, 0, 5 },
+    [0x96] = { "SUB M",     OP_SUB_M,    1,  7,  7, 0, 0 },
+    [0x97] = { "SUB A",     OP_SUB,      1,  4,  4, 0, 7 },
+    [0x98] = { "SBB B",     OP_SBB,      1,  4,  4, 0, 0 },
+    [0x99] = { "SBB C",     OP_SBB,      1,  4,  4, 0, 1 },
+    [0x9A] = { "SBB D",     OP_SBB,      1,  4,  4, 0, 2 },
+    [0x9B] = { "SBB E",     OP_SBB,      1,  4,  4, 0, 3 },
+    [0x9C] = { "SBB H",     OP_SBB,      1,  4,  4, 0, 4 },
+    [0x9D] = { "SBB L",     OP_SBB,      1,  4,  4, 0, 5 },
+    [0x9E] = { "SBB M",     OP_SBB_M,    1,  7,  7, 0, 0 },
+    [0x9F] = { "SBB A",     OP_SBB,      1,  4,  4, 0, 7 },
+    [0xA0] = { "ANA B",     OP_ANA,      1,  4,  4, 0, 0 },
+    [0xA1] = { "ANA C",     OP_ANA,      1,  4,  4, 0, 1 },
+    [0xA2] = { "ANA D",     OP_ANA,      1,  4,  4, 0, 2 },
+    [0xA3] = { "ANA E",     OP_ANA,      1,  4,  4, 0, 3 },
+    [0xA4] = { "ANA H",     OP_ANA,      1,  4,  4, 0, 4 },
+    [0xA5] = { "ANA L",     OP_ANA,      1,  4,  4, 0, 5 },
+    [0xA6] = { "ANA M",     OP_ANA_M,    1,  7,  7, 0, 0 },
+    [0xA7] = { "ANA A",     OP_ANA,      1,  4,  4, 0, 7 },
+    [0xA8] = { "XRA B",     OP_XRA,      1,  4,  4, 0, 0 },
+    [0xA9] = { "XRA C",     OP_XRA,      1,  4,  4, 0, 1 },
+    [0xAA] = { "XRA D",     OP_XRA,      1,  4,  4, 0, 2 },
+    [0xAB] = { "XRA E",     OP_XRA,      1,  4,  4, 0, 3 },
+    [0xAC] = { "XRA H",     OP_XRA,      1,  4,  4, 0, 4 },
+    [0xAD] = { "XRA L",     OP_XRA,      1,  4,  4, 0, 5 },
+    [0xAE] = { "XRA M",     OP_XRA_M,    1,  7,  7, 0, 0 },
+    [0xAF] = { "XRA A",     OP_XRA,      1,  4,  4, 0, 7 },
+    [0xB0] = { "ORA B",     OP_ORA,      1,  4,  4, 0, 0 },
+    [0xB1] = { "ORA C",     OP_ORA,      1,  4,  4, 0, 1 },
+    [0xB2] = { "ORA D",     OP_ORA,      1,  4,  4, 0, 2 },
+    [0xB3] = { "ORA E",     OP_ORA,      1,  4,  4, 0, 3 },
+    [0xB4] = { "ORA H",     OP_ORA,      1,  4,  4, 0, 4 },
+    [0xB5] = { "ORA L",     OP_ORA,      1,  4,  4, 0, 5 },
+    [0xB6] = { "ORA M",     OP_ORA_M,    1,  7,  7, 0, 0 },
+    [0xB7] = { "ORA A",     OP_ORA,      1,  4,  4, 0, 7 },
+    [0xB8] = { "CMP B",     OP_CMP,      1,  4,  4, 0, 0 },
+    [0xB9] = { "CMP C",     OP_CMP,      1,  4,  4, 0, 1 },
+    [0xBA] = { "CMP D",     OP_CMP,      1,  4,  4, 0, 2 },
+    [0xBB] = { "CMP E",     OP_CMP,      1,  4,  4, 0, 3 },
+    [0xBC] = { "CMP H",     OP_CMP,      1,  4,  4, 0, 4 },
+    [0xBD] = { "CMP L",     OP_CMP,      1,  4,  4, 0, 5 },
+    [0xBE] = { "CMP M",     OP_CMP_M,    1,  7,  7, 0, 0 },
+    [0xBF] = { "CMP A",     OP_CMP,      1,  4,  4, 0, 7 },
+    [0xC0] = { "RNZ",       OP_RCC,      1,  5, 11, 0, 0 },
+    [0xC1] = { "POP B",     OP_POP,      1, 10, 10, 0, 0 },
+    [0xC2] = { "JNZ",       OP_JCC,      3, 10, 10, 0, 0 },
+    [0xC3] = { "JMP",       OP_JMP,      3, 10, 10, 0, 0 },
+    [0xC4] = { "CNZ",       OP_CCC,      3, 11, 17, 0, 0 },
+    [0xC5] = { "PUSH B",    OP_PUSH,     1, 11, 11, 0, 0 },
+    [0xC6] = { "ADI",       OP_ADI,      2,  7,  7, 0, 0 },
+    [0xC7] = { "RST 0",     OP_RST,      1, 11, 11, 0, 0 },
+    [0xC8] = { "RZ",        OP_RCC,      1,  5, 11, 1, 0 },
+    [0xC9] = { "RET",       OP_RET,      1, 10, 10, 0, 0 },
+    [0xCA] = { "JZ",        OP_JCC,      3, 10, 10, 1, 0 },
+    [0xCB] = { "*JMP",      OP_JMP,      3, 10, 10, 0, 0 },
+    [0xCC] = { "CZ",        OP_CCC,      3, 11, 17, 1, 0 },
+    [0xCD] = { "CALL",      OP_CALL,     3, 17, 17, 0, 0 },
+    [0xCE] = { "ACI",       OP_ACI,      2,  7,  7, 0, 0 },
+    [0xCF] = { "RST 1",     OP_RST,      1, 11, 11, 1, 0 },
+    [0xD0] = { "RNC",       OP_RCC,      1,  5, 11, 2, 0 },
+    [0xD1] = { "POP D",     OP_POP,      1, 10, 10, 1, 0 },
+    [0xD2] = { "JNC",       OP_JCC,      3, 10, 10, 2, 0 },
+    [0xD3] = { "OUT",       OP_OUT,      2, 10, 10, 0, 0 },
+    [0xD4] = { "CNC",       OP_CCC,      3, 11, 17, 2, 0 },
+    [0xD5] = { "PUSH D",    OP_PUSH,     1, 11, 11, 1, 0 },
+    [0xD6] = { "SUI",       OP_SUI,      2,  7,  7, 0, 0 },
+    [0xD7] = { "RST 2",     OP_RST,      1, 11, 11, 2, 0 },
+    [0xD8] = { "RC",        OP_RCC,      1,  5, 11, 3, 0 },
+    [0xD9] = { "*RET",      OP_RET,      1, 10, 10, 0, 0 },
+    [0xDA] = { "JC",        OP_JCC,      3, 10, 10, 3, 0 },
+    [0xDB] = { "IN",        OP_IN,       2, 10, 10, 0, 0 },
+    [0xDC] = { "CC",        OP_CCC,      3, 11, 17, 3, 0 },
+    [0xDD] = { "*CALL",     OP_CALL,     3, 17, 17, 0, 0 },
+    [0xDE] = { "SBI",       OP_SBI,      2,  7,  7, 0, 0 },
+    [0xDF] = { "RST 3",     OP_RST,      1, 11, 11, 3, 0 },
+    [0xE0] = { "RPO",       OP_RCC,      1,  5, 11, 4, 0 },
+    [0xE1] = { "POP H",     OP_POP,      1, 10, 10, 2, 0 },
+    [0xE2] = { "JPO",       OP_JCC,      3, 10, 10, 4, 0 },
+    [0xE3] = { "XTHL",      OP_XTHL,     1, 18, 18, 0, 0 },
+    [0xE4] = { "CPO",       OP_CCC,      3, 11, 17, 4, 0 },
+    [0xE5] = { "PUSH H",    OP_PUSH,     1, 11, 11, 2, 0 },
+    [0xE6] = { "ANI",       OP_ANI,      2,  7,  7, 0, 0 },
+    [0xE7] = { "RST 4",     OP_RST,      1, 11, 11, 4, 0 },
+    [0xE8] = { "RPE",       OP_RCC,      1,  5, 11, 5, 0 },
+    [0xE9] = { "PCHL",      OP_PCHL,     1,  5,  5, 0, 0 },
+    [0xEA] = { "JPE",       OP_JCC,      3, 10, 10, 5, 0 },
+    [0xEB] = { "XCHG",      OP_XCHG,     1,  4,  4, 0, 0 },
+    [0xEC] = { "CPE",       OP_CCC,      3, 11, 17, 5, 0 },
+    [0xED] = { "*CALL",     OP_CALL,     3, 17, 17, 0, 0 },
+    [0xEE] = { "XRI",       OP_XRI,      2,  7,  7, 0, 0 },
+    [0xEF] = { "RST 5",     OP_RST,      1, 11, 11, 5, 0 },
+    [0xF0] = { "RP",        OP_RCC,      1,  5, 11, 6, 0 },
+    [0xF1] = { "POP PSW",   OP_POP_PSW,  1, 10, 10, 3, 0 },
+    [0xF2] = { "JP",        OP_JCC,      3, 10, 10, 6, 0 },
+    [0xF3] = { "DI",        OP_DI,       1,  4,  4, 0, 0 },
+    [0xF4] = { "CP",        OP_CCC,      3, 11, 17, 6, 0 },
+    [0xF5] = { "PUSH PSW",  OP_PUSH_PSW, 1, 11, 11, 3, 0 },
+    [0xF6] = { "ORI",       OP_ORI,      2,  7,  7, 0, 0 },
+    [0xF7] = { "RST 6",     OP_RST,      1, 11, 11, 6, 0 },
+    [0xF8] = { "RM",        OP_RCC,      1,  5, 11, 7, 0 },
+    [0xF9] = { "SPHL",      OP_SPHL,     1,  5,  5, 0, 0 },
+    [0xFA] = { "JM",        OP_JCC,      3, 10, 10, 7, 0 },
+    [0xFB] = { "EI",        OP_EI,       1,  4,  4, 0, 0 },
+    [0xFC] = { "CM",        OP_CCC,      3, 11, 17, 7, 0 },
+    [0xFD] = { "*CALL",     OP_CALL,     3, 17, 17, 0, 0 },
+    [0xFE] = { "CPI",       OP_CPI,      2,  7,  7, 0, 0 },
+    [0xFF] = { "RST 7",     OP_RST,      1, 11, 11, 7, 0 },
+};
@@ -0,0 +1,44 @@
+#ifndef OPCODES8080_H
+#define OPCODES8080_H
+
+#include <stdint.h>
+
+// Every kind of instruction the 8080 knows; each of the 256 opcodes maps to exactly one kind
+#define OPKINDS8080(X) \
+    X(NOP) X(LXI) X(STAX) X(LDAX) X(SHLD) X(LHLD) X(STA) X(LDA) \
+    X(INX) X(DCX) X(DAD) X(INR) X(DCR) X(INR_M) X(DCR_M) X(MVI) X(MVI_M) \
+    X(RLC) X(RRC) X(RAL) X(RAR) X(DAA) X(CMA) X(STC) X(CMC) \
+    X(MOV) X(MOV_RM) X(MOV_MR) X(HLT) \
+    X(ADD) X(ADC) X(SUB) X(SBB) X(ANA) X(XRA) X(ORA) X(CMP) \
+    X(ADD_M) X(ADC_M) X(SUB_M) X(SBB_M) X(ANA_M) X(XRA_M) X(ORA_M) X(CMP_M) \
+    X(ADI) X(ACI) X(SUI) X(SBI) X(ANI) X(XRI) X(ORI) X(CPI) \
+    X(RCC) X(RET) X(POP) X(POP_PSW) X(JCC) X(JMP) X(OUT) X(IN) \
+    X(XTHL) X(PCHL) X(SPHL) X(XCHG) X(DI) X(EI) X(CCC) X(CALL) \
+    X(PUSH) X(PUSH_PSW) X(RST)
+
+#define OPKIND8080_ENUM(name) OP_##name,
+enum
+{
+    OPKINDS8080(OPKIND8080_ENUM)
+    OP_KIND_COUNT
+};
+#undef OPKIND8080_ENUM
+
+// Static description of one opcode
+//   dst: destination register (B, C, D, E, H, L, M, A), register pair (B, D, H, SP/PSW),
+//        condition code (NZ, Z, NC, C, PO, PE, P, M) or RST number, depending on the kind
+//   src: source register for MOV and the register ALU operations
+typedef struct
+{
+    const char *mnemonic;   // Assembly text without the immediate operand
+    uint8_t kind;           // One of the OP_* kinds
+    uint8_t length;         // Instruction length in bytes
+    uint8_t cycles;         // States taken (conditional CALL/RET: condition not met)
+    uint8_t cyclesTaken;    // States taken when a conditional CALL/RET is taken
+    uint8_t dst;
+    uint8_t src;
+} Opcode8080;
+
+extern const Opcode8080 opcodes8080[256];
+
+#endif
@@ -0,0 +1,157 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "pool8080.h"
+
+#define TASK_EMPTY -1
+#define TASK_RETRY -2
+
+// Chase-Lev deque. Nothing is pushed once the workers run, so the task array
+// never grows: the owner takes from bottom, thieves race on top with a CAS.
+typedef struct
+{
+    _Alignas(64) atomic_long top;
+    _Alignas(64) atomic_long bottom;
+    int *tasks;
+} Deque8080;
+
+typedef struct
+{
+    Deque8080 *deques;
+    int threads;
+    Task8080 run;
+    void *context;
+    PoolStats8080 *stats;
+} Pool8080;
+
+typedef struct
+{
+    Pool8080 *pool;
+    int worker;
+} Worker8080;
+
+
+static int takeTask8080(Deque8080 *deque)
+{
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return TASK_EMPTY;
+    }
+
+    int task = deque->tasks[bottom];
+    if (top == bottom)
+    {
+        // Last task: a thief may be after it too
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+        {
+            task = TASK_EMPTY;
+        }
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+static int stealTask8080(Deque8080 *deque)
+{
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) return TASK_EMPTY;
+
+    int task = deque->tasks[top];
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+    {
+        return TASK_RETRY;
+    }
+    return task;
+}
+
+static void *worker8080(void *argument)
+{
+    Worker8080 *self = argument;
+    Pool8080 *pool = self->pool;
+    PoolStats8080 stats = {0, 0};
+    uint32_t seed = self->worker * 2654435761u + 1;
+
+    for (;;)
+    {
+        int task = takeTask8080(&pool->deques[self->worker]);
+
+        // Out of work: try the other workers from a random starting point until
+        // every deque is seen empty without losing a race
+        if (task == TASK_EMPTY)
+        {
+            int contended;
+            do
+            {
+                contended = 0;
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                for (int i = 0; i < pool->threads && task < 0; i++)
+                {
+                    int victim = (seed + i) % pool->threads;
+                    if (victim == self->worker) continue;
+                    task = stealTask8080(&pool->deques[victim]);
+                    if (task == TASK_RETRY) contended = 1;
+                }
+            }
+            while (task < 0 && contended);
+
+            if (task < 0) break;
+            stats.steals++;
+        }
+
+        pool->run(pool->context, task, self->worker);
+        stats.tasks++;
+    }
+
+    if (pool->stats != NULL) pool->stats[self->worker] = stats;
+    return NULL;
+}
+
+int runPool8080(int threads, int count, Task8080 run, void *context, PoolStats8080 *stats)
+{
+    Pool8080 pool = { NULL, threads, run, context, stats };
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    Worker8080 *workers = malloc(threads * sizeof(Worker8080));
+    int *tasks = malloc((count > 0 ? count : 1) * sizeof(int));
+    pool.deques = aligned_alloc(64, threads * sizeof(Deque8080));
+    int started = 0;
+    if (ids == NULL || workers == NULL || tasks == NULL || pool.deques == NULL) goto done;
+
+    // Contiguous shares, stored so the owner works through its share in order
+    for (int w = 0; w < threads; w++)
+    {
+        int first = (int64_t) count * w / threads;
+        int last = (int64_t) count * (w + 1) / threads;
+        Deque8080 *deque = &pool.deques[w];
+        deque->tasks = tasks + first;
+        for (int i = first; i < last; i++) deque->tasks[last - 1 - i] = i;
+        atomic_init(&deque->top, 0);
+        atomic_init(&deque->bottom, last - first);
+    }
+
+    // A thread that fails to start leaves its share to be stolen by the others
+    for (; started < threads; started++)
+    {
+        workers[started].pool = &pool;
+        workers[started].worker = started;
+        if (pthread_create(&ids[started], NULL, worker8080, &workers[started]) != 0) break;
+    }
+    for (int w = 0; w < started; w++) pthread_join(ids[w], NULL);
+
+done:
+    free(pool.deques);
+    free(tasks);
+    free(workers);
+    free(ids);
+    return started == threads;
+}
@@ -0,0 +1,24 @@
+#ifndef POOL8080_H
+#define POOL8080_H
+
+#include <stdint.h>
+
+// Work-stealing thread pool for running many independent machines. Tasks are the
+// integers 0..count-1. Each worker starts with an even share of them in its own
+// deque and pops from the bottom; a worker that runs dry steals from the top of
+// another worker's deque, so uneven tasks still keep every core busy.
+
+typedef void (*Task8080)(void *context, int task, int worker);
+
+typedef struct
+{
+    uint64_t tasks;             // Tasks this worker ran
+    uint64_t steals;            // Of those, taken from another worker
+} PoolStats8080;
+
+// Run every task on threads workers and wait for all of them. stats, if not NULL,
+// receives one entry per worker. Returns 0 if the pool could not be allocated or
+// not every worker started; any that did are joined first.
+int runPool8080(int threads, int count, Task8080 run, void *context, PoolStats8080 *stats);
+
+#endif
@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "opcodes8080.h"
+#include "profile8080.h"
+
+
+int startProfile8080(Profile8080 *p, Machine8080 *m)
+{
+    memset(p, 0, sizeof(*p));
+    p->nodes = calloc(PROFILE_NODES8080, sizeof(ProfileNode8080));
+    if (p->nodes == NULL) return 0;
+
+    // The root stands for everything run outside a call, from the reset vector
+    p->nodeCount = 1;
+    m->profile = p;
+    return 1;
+}
+
+static void charge8080(Profile8080 *p, Machine8080 *m)
+{
+    if (!p->pending) return;
+
+    uint64_t cycles = m->cycles - p->mark;
+    p->cycles[p->last] += cycles;
+    p->nodes[p->node].cycles += cycles;
+    p->pending = 0;
+    if (m->SP != p->lastSP) profileFlow8080(p, m);
+}
+
+void stopProfile8080(Profile8080 *p, Machine8080 *m)
+{
+    charge8080(p, m);
+    m->profile = NULL;
+}
+
+void freeProfile8080(Profile8080 *p)
+{
+    free(p->nodes);
+    p->nodes = NULL;
+}
+
+// Leave every frame entered at or below sp
+static void unwind8080(Profile8080 *p, uint16_t sp)
+{
+    while (p->depth > 0 && p->frames[p->depth - 1].sp <= sp) p->depth--;
+    p->node = p->depth > 0 ? p->frames[p->depth - 1].node : 0;
+}
+
+static void enter8080(Profile8080 *p, uint16_t address, uint16_t sp)
+{
+    // A frame at or below the new one was left without a return
+    unwind8080(p, sp);
+    if (p->depth == PROFILE_STACK_DEPTH8080)
+    {
+        p->lostFrames++;
+        return;
+    }
+
+    uint32_t child = p->nodes[p->node].child;
+    while (child != 0 && p->nodes[child].address != address) child = p->nodes[child].sibling;
+    if (child == 0 && p->nodeCount < PROFILE_NODES8080)
+    {
+        child = p->nodeCount++;
+        p->nodes[child] = (ProfileNode8080) { address, p->node, 0, p->nodes[p->node].child, 0 };
+        p->nodes[p->node].child = child;
+    }
+    // Out of nodes: the frame still goes on the stack, so its return finds it, but
+    // its states stay with the caller
+    if (child == 0)
+    {
+        p->lostFrames++;
+        child = p->node;
+    }
+
+    p->frames[p->depth].node = child;
+    p->frames[p->depth].sp = sp;
+    p->depth++;
+    p->node = child;
+}
+
+void profileFlow8080(Profile8080 *p, Machine8080 *m)
+{
+    switch (p->lastKind)
+    {
+        case OP_CALL: case OP_CCC: case OP_RST:
+            if (m->SP == (uint16_t) (p->lastSP - 2)) enter8080(p, m->pc, m->SP);
+            break;
+        case OP_RET: case OP_RCC:
+            // SP is now 2 above the frame being returned from
+            if (m->SP == (uint16_t) (p->lastSP + 2)) unwind8080(p, m->SP - 1);
+            break;
+        default:
+            break;
+    }
+}
+
+void profileInterrupt8080(Profile8080 *p, Machine8080 *m, uint16_t address)
+{
+    charge8080(p, m);
+
+    // Called before the return address goes on the stack; the states of the RST
+    // itself are charged to the vector once the next instruction starts
+    uint16_t sp = m->SP - 2;
+    enter8080(p, address, sp);
+    p->pending = 1;
+    p->last = address;
+    p->lastSP = sp;
+    p->lastKind = OP_NOP;
+    p->mark = m->cycles;
+}
+
+// Label of address in the analysis, or its address in hex
+static const char *symbol8080(const Analysis8080 *a, uint16_t address, char *buffer)
+{
+    uint8_t flags = a != NULL && address < a->size ? a->bytes[address] : 0;
+
+    if (flags & BYTE_SUBROUTINE8080) sprintf(buffer, "SUB_%04X", address);
+    else if (flags & (BYTE_LABEL8080 | BYTE_ENTRY8080)) sprintf(buffer, "L_%04X", address);
+    else sprintf(buffer, "%04X", address);
+    return buffer;
+}
+
+// Nearest label at or before address, plus the distance to it
+static const char *location8080(const Analysis8080 *a, uint16_t address, char *buffer)
+{
+    uint32_t label = address;
+    uint8_t mask = BYTE_SUBROUTINE8080 | BYTE_LABEL8080 | BYTE_ENTRY8080;
+
+    if (a == NULL || address >= a->size) return symbol8080(NULL, address, buffer);
+    while (label > 0 && !(a->bytes[label] & mask)) label--;
+    if (!(a->bytes[label] & mask)) return symbol8080(NULL, address, buffer);
+
+    symbol8080(a, label, buffer);
+    if (label != address) sprintf(buffer + strlen(buffer), "+%u", address - label);
+    return buffer;
+}
+
+static const Profile8080 *sortProfile8080;
+
+static int compareOpcodes8080(const void *x, const void *y)
+{
+    uint64_t a = sortProfile8080->opcodes[*(const uint16_t *) x];
+    uint64_t b = sortProfile8080->opcodes[*(const uint16_t *) y];
+    return (a < b) - (a > b);
+}
+
+static int compareCycles8080(const void *x, const void *y)
+{
+    uint64_t a = sortProfile8080->cycles[*(const uint16_t *) x];
+    uint64_t b = sortProfile8080->cycles[*(const uint16_t *) y];
+    return (a < b) - (a > b);
+}
+
+void writeReport8080(const Profile8080 *p, FILE *file, const Analysis8080 *a, int top)
+{
+    static uint16_t order[MEMORY_SIZE8080];
+    uint64_t instructions = 0, cycles = 0;
+    char name[32];
+
+    for (int i = 0; i < 256; i++) instructions += p->opcodes[i];
+    for (int i = 0; i < MEMORY_SIZE8080; i++) cycles += p->cycles[i];
+    if (instructions == 0) instructions = 1;
+    if (cycles == 0) cycles = 1;
+
+    sortProfile8080 = p;
+    for (int i = 0; i < 256; i++) order[i] = i;
+    qsort(order, 256, sizeof(order[0]), compareOpcodes8080);
+    fprintf(file, "opcodes by executions:\n");
+    for (int i = 0; i < 256 && p->opcodes[order[i]] != 0; i++)
+    {
+        const Opcode8080 *op = &opcodes8080[order[i]];
+        fprintf(file, "  %02X  %-10s %12llu  %5.2f%%\n", order[i], op->mnemonic,
+                (unsigned long long) p->opcodes[order[i]], 100.0 * p->opcodes[order[i]] / instructions);
+    }
+
+    for (int i = 0; i < MEMORY_SIZE8080; i++) order[i] = i;
+    qsort(order, MEMORY_SIZE8080, sizeof(order[0]), compareCycles8080);
+    fprintf(file, "\nhot spots by states:\n");
+    for (int i = 0; i < top && p->cycles[order[i]] != 0; i++)
+    {
+        fprintf(file, "  %04X  %-14s %12llu executions %12llu states  %5.2f%%\n", order[i], location8080(a, order[i], name),
+                (unsigned long long) p->counts[order[i]], (unsigned long long) p->cycles[order[i]],
+                100.0 * p->cycles[order[i]] / cycles);
+    }
+    if (p->lostFrames != 0) fprintf(file, "\n%llu calls too deep to track\n", (unsigned long long) p->lostFrames);
+}
+
+void writeFolded8080(const Profile8080 *p, FILE *file, const Analysis8080 *a)
+{
+    uint32_t path[PROFILE_STACK_DEPTH8080 + 1];
+    char name[32];
+
+    for (uint32_t node = 0; node < p->nodeCount; node++)
+    {
+        if (p->nodes[node].cycles == 0) continue;
+
+        // Nodes are only made for frames on the stack, so no path is deeper than it
+        int depth = 0;
+        for (uint32_t n = node; n != 0; n = p->nodes[n].parent) path[depth++] = n;
+        path[depth++] = 0;
+
+        while (depth > 0)
+        {
+            fputs(symbol8080(a, p->nodes[path[--depth]].address, name), file);
+            fputc(depth > 0 ? ';' : ' ', file);
+        }
+        fprintf(file, "%llu\n", (unsigned long long) p->nodes[node].cycles);
+    }
+}
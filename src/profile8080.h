@@ -0,0 +1,103 @@
+#ifndef PROFILE8080_H
+#define PROFILE8080_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "analysis8080.h"
+#include "cpu8080.h"
+
+// Guest profiler. While a profile is attached to a machine, runFrame8080 runs it on
+// a computed-goto loop built with a profiling hook (the other loops have none, so
+// an unprofiled machine pays nothing). The hook counts every opcode, and the
+// executions and states of every address; the states an instruction takes are
+// charged when the next one starts, so taken conditional CALL/RET and interrupts
+// are included.
+//
+// CALL, Ccc, RST and interrupts that push a return address enter a frame on a
+// shadow call stack, and RET and Rcc that pop one leave it. Frames remember the
+// stack pointer at their entry, so one left without a return (a return address
+// popped and thrown away, SP reloaded) is dropped as soon as a return or call
+// shows the guest stack has moved above it. States are charged to the current
+// node of a call tree, which is written out as folded stacks, one line per stack:
+//   L_0000;SUB_0010;SUB_1ACD 5125
+// for flamegraph.pl and the like.
+
+#define PROFILE_STACK_DEPTH8080 64
+#define PROFILE_NODES8080 (1 << 14)
+
+typedef struct
+{
+    uint16_t address;           // Entry of the subroutine
+    uint32_t parent;
+    uint32_t child;             // First child, 0 for none (node 0 is the root)
+    uint32_t sibling;
+    uint64_t cycles;            // States spent in it, not counting its callees
+} ProfileNode8080;
+
+struct Profile8080
+{
+    uint64_t opcodes[256];
+    uint64_t counts[MEMORY_SIZE8080];
+    uint64_t cycles[MEMORY_SIZE8080];
+
+    // Instruction executed last, whose states are charged when the next one starts
+    int pending;
+    uint16_t last;
+    uint16_t lastSP;
+    uint8_t lastKind;
+    uint64_t mark;
+
+    // Call tree and the shadow stack of frames into it
+    ProfileNode8080 *nodes;
+    uint32_t nodeCount;
+    uint32_t node;
+    struct
+    {
+        uint32_t node;
+        uint16_t sp;            // Guest SP just after the return address was pushed
+    } frames[PROFILE_STACK_DEPTH8080];
+    int depth;
+    uint64_t lostFrames;        // Calls too deep for the stack or the tree
+};
+
+// Allocate a profile and attach it to the machine. Returns 0 if out of memory.
+int startProfile8080(Profile8080 *p, Machine8080 *m);
+// Charge the last instruction and detach the profile from the machine
+void stopProfile8080(Profile8080 *p, Machine8080 *m);
+void freeProfile8080(Profile8080 *p);
+
+// Opcode histogram and the top hot spots by states. Addresses are named after
+// the analysis' labels when one is given (it may be NULL).
+void writeReport8080(const Profile8080 *p, FILE *file, const Analysis8080 *a, int top);
+// One line per distinct call stack with the states spent at its top
+void writeFolded8080(const Profile8080 *p, FILE *file, const Analysis8080 *a);
+
+// Out of line: the last instruction was a call or return that moved SP
+void profileFlow8080(Profile8080 *p, Machine8080 *m);
+// Out of line, from interrupt8080 before it pushes the return address: enter the
+// frame of the interrupt routine at address
+void profileInterrupt8080(Profile8080 *p, Machine8080 *m, uint16_t address);
+
+// The hook of the profiled loop, called before the instruction at m->pc executes
+static inline void profileRecord8080(Machine8080 *m, const uint8_t *instruction, const Dispatch8080 *entry)
+{
+    Profile8080 *p = m->profile;
+
+    if (p->pending)
+    {
+        uint64_t cycles = m->cycles - p->mark;
+        p->cycles[p->last] += cycles;
+        p->nodes[p->node].cycles += cycles;
+        if (m->SP != p->lastSP) profileFlow8080(p, m);
+    }
+    p->pending = 1;
+    p->last = m->pc;
+    p->lastSP = m->SP;
+    p->lastKind = entry->kind;
+    p->mark = m->cycles;
+    p->counts[m->pc]++;
+    p->opcodes[*instruction]++;
+}
+
+#endif
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "aot8080.h"
+#include "disasm8080.h"
+#include "opcodes8080.h"
+
+// Usage: recompiler rom > rom_aot.c
+// Walks the control flow of a ROM image from the reset and interrupt vectors and
+// prints a C file with one function per basic block, to be linked with aot8080.c.
+// Every instruction becomes an AOT8080() line that expands to the interpreter's own
+// handler with constant operands, so the compiled code behaves exactly like it.
+
+#define KINDNAME8080(name) #name,
+static const char *const kindNames8080[OP_KIND_COUNT] = { OPKINDS8080(KINDNAME8080) };
+#undef KINDNAME8080
+
+static uint8_t *rom;
+static uint32_t romSize;
+static uint8_t *leaders;
+static uint32_t *worklist;
+static int pending = 0;
+
+// Static successors of the block being scanned, filled in by scanBlock
+static uint32_t successors[2];
+static int successorCount;
+
+
+static void addLeader(uint32_t address)
+{
+    if (address < romSize && successorCount < 2) successors[successorCount++] = address;
+    if (address >= romSize || leaders[address]) return;
+    leaders[address] = 1;
+    worklist[pending++] = address;
+}
+
+// Follow one block from its start, queueing every address control can reach from
+// its last instruction; returns the address just past the block
+static uint32_t scanBlock(uint32_t address)
+{
+    successorCount = 0;
+    while (address < romSize)
+    {
+        const Opcode8080 *op = &opcodes8080[rom[address]];
+        uint32_t next = address + op->length;
+        uint16_t target = rom[address + 1] | (rom[address + 2] << 8);
+
+        switch (op->kind)
+        {
+            case OP_JMP: addLeader(target); return next;
+            case OP_JCC: case OP_CALL: case OP_CCC: addLeader(target); addLeader(next); return next;
+            case OP_RST: addLeader(op->dst << 3); addLeader(next); return next;
+            case OP_RCC: addLeader(next); return next;
+            // HLT resumes after itself once an interrupt arrives, through the dispatch loop
+            case OP_HLT: addLeader(next); successorCount = 0; return next;
+            // Computed targets are left to the interpreter
+            case OP_RET: case OP_PCHL: return next;
+            default: address = next; break;
+        }
+    }
+    return address;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        printf("Please include a file when running the 8080 recompiler.\n");
+        exit(1);
+    }
+    FILE *f = fopen(argv[1], "rb");
+    if (f == NULL)
+    {
+        printf("error: could not read file %s\n", argv[1]);
+        exit(2);
+    }
+
+    fseek(f, 0L, SEEK_END);
+    romSize = ftell(f);
+    fseek(f, 0L, SEEK_SET);
+
+    // Operand fetches of the last instruction may run past the end of the image
+    rom = calloc(romSize + 3, 1);
+    leaders = calloc(romSize, 1);
+    worklist = malloc(romSize * sizeof(uint32_t));
+    fread(rom, romSize, 1, f);
+    fclose(f);
+
+    // Reset, then the two vectors the video hardware raises every frame
+    addLeader(0x0000);
+    addLeader(0x0008);
+    addLeader(0x0010);
+    while (pending > 0) scanBlock(worklist[--pending]);
+
+    printf("// Generated by recompiler from %s, do not edit\n\n", argv[1]);
+    printf("#include \"aot8080.h\"\n#include \"handlers8080.h\"\n\n");
+    printf("const uint32_t aotSize8080 = 0x%04X;\n", romSize);
+    printf("const uint64_t aotChecksum8080 = 0x%016llXULL;\n", (unsigned long long) checksumAot8080(rom, romSize));
+
+    // Blocks call each other, so declare them all first
+    printf("\n");
+    for (uint32_t start = 0; start < romSize; start++)
+    {
+        if (leaders[start]) printf("static void aotBlock%04X(Machine8080 *m);\n", start);
+    }
+
+    int blocks = 0;
+    for (uint32_t start = 0; start < romSize; start++)
+    {
+        if (!leaders[start]) continue;
+        uint32_t end = scanBlock(start);
+        blocks++;
+
+        printf("\nstatic void aotBlock%04X(Machine8080 *m)\n{\n", start);
+        for (uint32_t address = start; address < end; address += opcodes8080[rom[address]].length)
+        {
+            const Opcode8080 *op = &opcodes8080[rom[address]];
+            printf("    // %04X    ", address);
+            disassembleOp8080(rom, address);
+            printf("    AOT8080(0x%04X, %s, %d, %d, %d, %d, %d, 0x%02X, 0x%02X, 0x%02X)\n", address, kindNames8080[op->kind],
+                   op->length, op->cycles, op->cyclesTaken, op->dst, op->src, rom[address], rom[address + 1], rom[address + 2]);
+        }
+        for (int i = 0; i < successorCount; i++) printf("    AOTCHAIN8080(%04X)\n", successors[i]);
+        printf("}\n");
+    }
+
+    printf("\nconst AotBlock8080 aotBlocks8080[0x%04X] = {\n", romSize);
+    for (uint32_t start = 0; start < romSize; start++)
+    {
+        if (leaders[start]) printf("    [0x%04X] = aotBlock%04X,\n", start, start);
+    }
+    printf("};\n");
+
+    fprintf(stderr, "%d blocks\n", blocks);
+    return 0;
+}
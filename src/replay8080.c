@@ -0,0 +1,234 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay8080.h"
+#include "rewind8080.h"
+
+// Checkpoints are encoded against an all-zero snapshot
+static const State8080 empty8080;
+
+
+static void putVarint8080(FILE *file, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        putc(0x80 | (value & 0x7F), file);
+        value >>= 7;
+    }
+    putc(value, file);
+}
+
+static int getVarint8080(FILE *file, uint64_t *value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int c = getc(file);
+        if (c == EOF) return 0;
+        *value |= (uint64_t) (c & 0x7F) << shift;
+        if (!(c & 0x80)) return 1;
+    }
+    return 0;
+}
+
+int openRecording8080(Recorder8080 *r, const char *path, int interval, Machine8080 *m)
+{
+    ReplayHeader8080 header;
+
+    memset(r, 0, sizeof(*r));
+    r->interval = interval > 0 ? interval : REPLAY_DEFAULT_INTERVAL;
+    r->encoded = malloc(DELTA_MAX8080(sizeof(State8080)));
+    r->file = fopen(path, "wb");
+    if (r->encoded == NULL || r->file == NULL)
+    {
+        closeRecording8080(r);
+        return 0;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+    header.version = STATE_VERSION8080;
+    header.romSize = m->romSize;
+    fwrite(&header, sizeof(header), 1, r->file);
+    return 1;
+}
+
+static void writeCheckpoint8080(Recorder8080 *r, Machine8080 *m, uint64_t frame)
+{
+    saveState8080(m, &r->state);
+    size_t size = encodeDelta8080((const uint8_t *) &r->state, (const uint8_t *) &empty8080, sizeof(State8080), r->encoded);
+
+    putc(REPLAY_CHECKPOINT8080, r->file);
+    putVarint8080(r->file, frame);
+    putVarint8080(r->file, m->cycles);
+    putVarint8080(r->file, size);
+    fwrite(r->encoded, 1, size, r->file);
+
+    memcpy(r->input, m->input, sizeof(r->input));
+    r->frame = frame;
+    r->cycles = m->cycles;
+    r->checkpoints++;
+}
+
+void recordFrame8080(Recorder8080 *r, Machine8080 *m, uint64_t frame)
+{
+    // The first frame, and any jump backwards (a rewind or a seek), start from a
+    // checkpoint since deltas cannot go negative
+    if (r->checkpoints == 0 || frame < r->frame || m->cycles < r->cycles)
+    {
+        writeCheckpoint8080(r, m, frame);
+        return;
+    }
+
+    // Changes go before a checkpoint on the same frame, so a replay reading
+    // straight through sees them too
+    for (int port = 1; port <= 2; port++)
+    {
+        if (m->input[port - 1] == r->input[port - 1]) continue;
+        putc(port, r->file);
+        putVarint8080(r->file, frame - r->frame);
+        putVarint8080(r->file, m->cycles - r->cycles);
+        putc(m->input[port - 1], r->file);
+
+        r->input[port - 1] = m->input[port - 1];
+        r->frame = frame;
+        r->cycles = m->cycles;
+        r->events++;
+    }
+    if (frame % r->interval == 0) writeCheckpoint8080(r, m, frame);
+}
+
+void closeRecording8080(Recorder8080 *r)
+{
+    if (r->file != NULL) fclose(r->file);
+    free(r->encoded);
+    r->file = NULL;
+    r->encoded = NULL;
+}
+
+// Read the next record into p unless one is already pending. The snapshot of a
+// checkpoint is left in p->encoded, and its length in size if that is not NULL.
+static int readRecord8080(Replay8080 *p, size_t *size)
+{
+    uint64_t frame, cycles, length;
+
+    if (p->pending) return 1;
+
+    int tag = getc(p->file);
+    if (tag == REPLAY_CHECKPOINT8080)
+    {
+        if (!getVarint8080(p->file, &frame) || !getVarint8080(p->file, &cycles) || !getVarint8080(p->file, &length)) return 0;
+        if (length > DELTA_MAX8080(sizeof(State8080)) || fread(p->encoded, 1, length, p->file) != length) return 0;
+        if (size != NULL) *size = length;
+        p->frame = frame;
+        p->cycles = cycles;
+    }
+    else if (tag == 1 || tag == 2)
+    {
+        if (!getVarint8080(p->file, &frame) || !getVarint8080(p->file, &cycles)) return 0;
+        int value = getc(p->file);
+        if (value == EOF) return 0;
+        p->frame += frame;
+        p->cycles += cycles;
+        p->value = value;
+    }
+    else return 0;
+
+    p->tag = tag;
+    p->pending = 1;
+    return 1;
+}
+
+int openReplay8080(Replay8080 *p, const char *path, Machine8080 *m)
+{
+    ReplayHeader8080 header;
+    int capacity = 0;
+
+    memset(p, 0, sizeof(*p));
+    p->encoded = malloc(DELTA_MAX8080(sizeof(State8080)));
+    p->file = fopen(path, "rb");
+    if (p->encoded == NULL || p->file == NULL || fread(&header, sizeof(header), 1, p->file) != 1 ||
+        memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != STATE_VERSION8080 || header.romSize != m->romSize)
+    {
+        closeReplay8080(p);
+        return 0;
+    }
+
+    // Index the checkpoints, then start over at the first record
+    for (;;)
+    {
+        long offset = ftell(p->file);
+        if (!readRecord8080(p, NULL)) break;
+        p->pending = 0;
+        if (p->tag != REPLAY_CHECKPOINT8080) continue;
+
+        if (p->checkpointCount == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 64;
+            Checkpoint8080 *grown = realloc(p->checkpoints, capacity * sizeof(Checkpoint8080));
+            if (grown == NULL) break;
+            p->checkpoints = grown;
+        }
+        p->checkpoints[p->checkpointCount].frame = p->frame;
+        p->checkpoints[p->checkpointCount].offset = offset;
+        p->checkpointCount++;
+    }
+    fseek(p->file, sizeof(header), SEEK_SET);
+    p->frame = 0;
+    p->cycles = 0;
+    return 1;
+}
+
+void applyReplay8080(Replay8080 *p, Machine8080 *m, uint64_t frame)
+{
+    while (readRecord8080(p, NULL) && p->frame <= frame)
+    {
+        p->pending = 0;
+        if (p->frame == frame && p->cycles != m->cycles) p->desyncs++;
+        if (p->tag == REPLAY_CHECKPOINT8080) continue;
+
+        m->input[p->tag - 1] = p->value;
+        p->events++;
+    }
+}
+
+int seekReplay8080(Replay8080 *p, Machine8080 *m, uint64_t frame)
+{
+    int found = -1;
+    size_t size;
+
+    // Checkpoints are in file order, which goes back in frames wherever the
+    // recording jumped back; the last suitable one in the file wins
+    for (int i = 0; i < p->checkpointCount; i++)
+    {
+        if (p->checkpoints[i].frame <= frame && (found < 0 || p->checkpoints[i].frame >= p->checkpoints[found].frame)) found = i;
+    }
+    if (found < 0) return 0;
+
+    fseek(p->file, p->checkpoints[found].offset, SEEK_SET);
+    p->pending = 0;
+    if (!readRecord8080(p, &size)) return 0;
+    p->pending = 0;
+
+    memset(&p->state, 0, sizeof(p->state));
+    applyDelta8080((uint8_t *) &p->state, p->encoded, size);
+    if (!loadState8080(m, &p->state)) return 0;
+
+    for (uint64_t f = p->checkpoints[found].frame; f < frame; f++)
+    {
+        applyReplay8080(p, m, f);
+        runFrame8080(m, 0);
+    }
+    return 1;
+}
+
+void closeReplay8080(Replay8080 *p)
+{
+    if (p->file != NULL) fclose(p->file);
+    free(p->checkpoints);
+    free(p->encoded);
+    p->file = NULL;
+    p->checkpoints = NULL;
+    p->encoded = NULL;
+}
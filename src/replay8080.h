@@ -0,0 +1,91 @@
+#ifndef REPLAY8080_H
+#define REPLAY8080_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "cpu8080.h"
+#include "state8080.h"
+
+// Input recordings. A log holds the values of input ports 1 and 2 each time one
+// changes, and a checkpoint (a save state) every so many frames, so a replay can
+// seek to any frame by loading the nearest checkpoint before it and running the
+// rest headless. The format is append-only and can be written and read as a stream.
+//
+// After the header the log is a sequence of records, with unsigned LEB128 varints:
+//   port 1 or 2 (1 byte), frame delta, cycle delta, new value (1 byte)
+//   0x80, frame, cycles, encoded size, snapshot encoded with encodeDelta8080
+//        against an all-zero State8080
+// Deltas are relative to the previous record. Inputs are sampled at frame
+// boundaries: a change is logged as the frame it applies from and the machine's
+// cycle count when that frame starts, which replay checks to detect a desync.
+
+#define REPLAY_MAGIC "8080INP1"
+#define REPLAY_CHECKPOINT8080 0x80
+#define REPLAY_DEFAULT_INTERVAL 600
+
+typedef struct
+{
+    char magic[8];
+    uint32_t version;           // STATE_VERSION8080 of the checkpoints
+    uint32_t romSize;
+} ReplayHeader8080;
+
+typedef struct
+{
+    FILE *file;
+    int interval;               // Frames between checkpoints
+    uint8_t input[2];           // Last values logged
+    uint64_t frame;             // Frame and cycles of the last record
+    uint64_t cycles;
+    State8080 state;
+    uint8_t *encoded;
+
+    uint64_t events;
+    uint64_t checkpoints;
+} Recorder8080;
+
+typedef struct
+{
+    uint64_t frame;
+    long offset;                // Of the record in the file
+} Checkpoint8080;
+
+typedef struct
+{
+    FILE *file;
+    Checkpoint8080 *checkpoints;
+    int checkpointCount;
+
+    // Record read ahead but not applied yet
+    int pending;
+    int tag;
+    uint64_t frame;
+    uint64_t cycles;
+    uint8_t value;
+
+    State8080 state;
+    uint8_t *encoded;
+
+    uint64_t events;
+    uint64_t desyncs;           // Records whose cycle count did not match the machine's
+} Replay8080;
+
+// Start logging m's input to path with a checkpoint every interval frames. Returns 0 on failure.
+int openRecording8080(Recorder8080 *r, const char *path, int interval, Machine8080 *m);
+// Call at the start of every frame, once m->input holds the values for it: writes
+// a checkpoint when one is due and logs the ports that changed
+void recordFrame8080(Recorder8080 *r, Machine8080 *m, uint64_t frame);
+void closeRecording8080(Recorder8080 *r);
+
+// Open a log and index its checkpoints. Returns 0 if it is unreadable or for another ROM.
+int openReplay8080(Replay8080 *p, const char *path, Machine8080 *m);
+// Set m->input for frame from the log; call before running it
+void applyReplay8080(Replay8080 *p, Machine8080 *m, uint64_t frame);
+// Put the machine at the start of frame: load the last checkpoint at or before it
+// and run the remaining frames untraced on m's engine. Returns 0 if the log has no
+// checkpoint that early.
+int seekReplay8080(Replay8080 *p, Machine8080 *m, uint64_t frame);
+void closeReplay8080(Replay8080 *p);
+
+#endif
@@ -0,0 +1,216 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "rewind8080.h"
+
+_Static_assert(sizeof(State8080) < 0x8000, "run lengths must fit in 15 bits");
+
+// Keyframes are encoded against an all-zero snapshot
+static const State8080 empty8080;
+
+
+// Run lengths take one byte below 128 and two otherwise
+static inline size_t putLength8080(uint8_t *out, size_t length)
+{
+    if (length < 0x80)
+    {
+        out[0] = length;
+        return 1;
+    }
+    out[0] = 0x80 | (length & 0x7F);
+    out[1] = length >> 7;
+    return 2;
+}
+
+static inline const uint8_t *getLength8080(const uint8_t *in, size_t *length)
+{
+    if (in[0] < 0x80)
+    {
+        *length = in[0];
+        return in + 1;
+    }
+    *length = (in[0] & 0x7F) | (size_t) in[1] << 7;
+    return in + 2;
+}
+
+// A run of changed bytes ends at 3 unchanged ones, where a new token is no bigger
+// than carrying them along
+size_t encodeDelta8080(const uint8_t *a, const uint8_t *b, size_t size, uint8_t *out)
+{
+    size_t i = 0;
+    size_t length = 0;
+
+    while (i < size)
+    {
+        size_t start = i;
+        uint64_t x, y;
+        while (i + 8 <= size)
+        {
+            memcpy(&x, a + i, 8);
+            memcpy(&y, b + i, 8);
+            if (x != y) break;
+            i += 8;
+        }
+        while (i < size && a[i] == b[i]) i++;
+        size_t zeros = i - start;
+
+        start = i;
+        while (i < size)
+        {
+            if (a[i] != b[i])
+            {
+                i++;
+                continue;
+            }
+            size_t same = i;
+            while (same < size && same - i < 3 && a[same] == b[same]) same++;
+            if (same - i == 3) break;
+            i = same;
+        }
+
+        length += putLength8080(out + length, zeros);
+        length += putLength8080(out + length, i - start);
+        for (size_t j = start; j < i; j++) out[length++] = a[j] ^ b[j];
+    }
+    return length;
+}
+
+void applyDelta8080(uint8_t *state, const uint8_t *in, size_t length)
+{
+    const uint8_t *end = in + length;
+    size_t position = 0;
+
+    while (in < end)
+    {
+        size_t zeros, literals;
+        in = getLength8080(in, &zeros);
+        in = getLength8080(in, &literals);
+        position += zeros;
+        for (size_t j = 0; j < literals; j++) state[position + j] ^= in[j];
+        position += literals;
+        in += literals;
+    }
+}
+
+int initRewind8080(Rewind8080 *r, size_t capacity, int interval)
+{
+    memset(r, 0, sizeof(*r));
+    r->capacity = capacity;
+    r->interval = interval > 0 ? interval : 1;
+    // Far more entries than a ring of typical deltas can hold
+    r->maxEntries = capacity / 64 + 1;
+    r->data = malloc(capacity);
+    r->entries = malloc(r->maxEntries * sizeof(RewindEntry8080));
+    r->encoded = malloc(DELTA_MAX8080(sizeof(State8080)));
+    if (r->data == NULL || r->entries == NULL || r->encoded == NULL)
+    {
+        freeRewind8080(r);
+        return 0;
+    }
+    return 1;
+}
+
+void freeRewind8080(Rewind8080 *r)
+{
+    free(r->data);
+    free(r->entries);
+    free(r->encoded);
+    r->data = NULL;
+    r->entries = NULL;
+    r->encoded = NULL;
+    r->count = 0;
+}
+
+static void dropOldest8080(Rewind8080 *r)
+{
+    r->used -= r->entries[r->first].size;
+    r->first = (r->first + 1) % r->maxEntries;
+    r->count--;
+}
+
+// Make room for size contiguous bytes and return where they start. Snapshots are
+// laid out in order around the ring, so the ones in the way are always the oldest;
+// a snapshot that does not fit before the end of the buffer starts again at 0.
+static size_t reserve8080(Rewind8080 *r, size_t size)
+{
+    size_t position = r->head;
+    size_t consumed = size;
+
+    if (position + size > r->capacity)
+    {
+        consumed += r->capacity - position;
+        position = 0;
+    }
+    while (r->count > 0)
+    {
+        size_t ahead = (r->entries[r->first].offset + r->capacity - r->head) % r->capacity;
+        if (ahead >= consumed && r->count < r->maxEntries) break;
+        dropOldest8080(r);
+    }
+    // Deltas are useless without their keyframe
+    while (r->count > 0 && r->entries[r->first].keyDistance != 0) dropOldest8080(r);
+    return position;
+}
+
+int pushRewind8080(Rewind8080 *r, Machine8080 *m)
+{
+    uint32_t distance = 0;
+    size_t size;
+
+    saveState8080(m, &r->current);
+    if (r->count > 0) distance = r->entries[(r->first + r->count - 1) % r->maxEntries].keyDistance + 1;
+    if (distance >= (uint32_t) r->interval) distance = 0;
+
+    if (distance == 0) size = encodeDelta8080((const uint8_t *) &r->current, (const uint8_t *) &empty8080, sizeof(State8080), r->encoded);
+    else size = encodeDelta8080((const uint8_t *) &r->current, (const uint8_t *) &r->key, sizeof(State8080), r->encoded);
+    if (size > r->capacity) return 0;
+
+    size_t position = reserve8080(r, size);
+    if (distance != 0 && r->count == 0)
+    {
+        // Making room dropped this delta's own keyframe, so it becomes one
+        distance = 0;
+        size = encodeDelta8080((const uint8_t *) &r->current, (const uint8_t *) &empty8080, sizeof(State8080), r->encoded);
+        if (size > r->capacity) return 0;
+        position = reserve8080(r, size);
+    }
+    if (distance == 0)
+    {
+        r->key = r->current;
+        r->keyframes++;
+    }
+
+    memcpy(r->data + position, r->encoded, size);
+    RewindEntry8080 *entry = &r->entries[(r->first + r->count) % r->maxEntries];
+    entry->offset = position;
+    entry->size = size;
+    entry->keyDistance = distance;
+    r->count++;
+    r->head = position + size;
+    r->used += size;
+    r->pushes++;
+    r->pushedBytes += size;
+    return 1;
+}
+
+int rewindMachine8080(Rewind8080 *r, Machine8080 *m, int steps)
+{
+    if (r->count == 0) return -1;
+    if (steps > r->count - 1) steps = r->count - 1;
+    if (steps < 0) steps = 0;
+
+    int index = (r->first + r->count - 1 - steps) % r->maxEntries;
+    const RewindEntry8080 *entry = &r->entries[index];
+    const RewindEntry8080 *key = &r->entries[(index - (int) entry->keyDistance + r->maxEntries) % r->maxEntries];
+
+    memset(&r->key, 0, sizeof(r->key));
+    applyDelta8080((uint8_t *) &r->key, r->data + key->offset, key->size);
+    r->current = r->key;
+    if (entry != key) applyDelta8080((uint8_t *) &r->current, r->data + entry->offset, entry->size);
+    if (!loadState8080(m, &r->current)) return -1;
+
+    for (int i = 0; i < steps; i++) r->used -= r->entries[(index + 1 + i) % r->maxEntries].size;
+    r->count -= steps;
+    r->head = entry->offset + entry->size;
+    return steps;
+}
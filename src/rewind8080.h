@@ -0,0 +1,68 @@
+#ifndef REWIND8080_H
+#define REWIND8080_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpu8080.h"
+#include "state8080.h"
+
+// Rewind buffer: a snapshot every frame, kept in a fixed-size ring of bytes. Every
+// interval-th snapshot is a keyframe; the ones in between are stored as the XOR
+// against their keyframe, and both are run-length encoded: a sequence of
+// (unchanged byte count, changed byte count, the changed bytes) tokens with 1- or
+// 2-byte counts, so a frame that only touches a few hundred bytes of RAM costs
+// about as much. When the ring is full the oldest keyframe and its deltas are
+// dropped together. Invaders does best with a keyframe every 20 frames or so, as
+// deltas grow quickly while the invaders march.
+
+// A new token only starts after 3 unchanged bytes, more than its header takes, so
+// an encoding is never longer than this
+#define DELTA_MAX8080(size) ((size) + 4)
+
+// Encode a ^ b into out, returning its length
+size_t encodeDelta8080(const uint8_t *a, const uint8_t *b, size_t size, uint8_t *out);
+// XOR an encoding into state
+void applyDelta8080(uint8_t *state, const uint8_t *in, size_t length);
+
+typedef struct
+{
+    uint32_t offset;            // Start of the encoded snapshot in data
+    uint32_t size;
+    uint32_t keyDistance;       // Snapshots since its keyframe, 0 for a keyframe
+} RewindEntry8080;
+
+typedef struct
+{
+    uint8_t *data;
+    size_t capacity;
+    size_t head;                // Where the next snapshot goes
+    size_t used;                // Bytes held by live snapshots
+
+    RewindEntry8080 *entries;   // Ring of snapshots, oldest at first
+    int maxEntries;
+    int first;
+    int count;
+    int interval;
+
+    State8080 key;              // Keyframe the newest snapshot was encoded against
+    State8080 current;
+    uint8_t *encoded;           // Encoding of the snapshot being pushed
+
+    uint64_t pushes;
+    uint64_t keyframes;
+    uint64_t pushedBytes;
+} Rewind8080;
+
+// capacity bytes of history, a keyframe every interval snapshots. Returns 0 on failure.
+int initRewind8080(Rewind8080 *r, size_t capacity, int interval);
+void freeRewind8080(Rewind8080 *r);
+
+// Snapshot the machine as the newest entry. Returns 0 if a single snapshot does not fit.
+int pushRewind8080(Rewind8080 *r, Machine8080 *m);
+// Load the snapshot steps entries before the newest (0 is the newest itself) and
+// drop everything after it, so pushing continues from there. Fewer steps are taken
+// when the history is shorter; returns the number taken, or -1 if it is empty.
+int rewindMachine8080(Rewind8080 *r, Machine8080 *m, int steps);
+
+#endif
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cpu8080.h"
+#include "memory8080.h"
+#include "rom8080.h"
+
+// The board decodes A0-A13 only, so its 16 KiB repeat over the whole address space
+#define INVADERS_PAGES8080 (0x4000 >> 8)
+
+// The four 2 KiB chips of the Space Invaders board, in address order
+static const struct
+{
+    const char *name;
+    uint16_t address;
+} invadersChips8080[] =
+{
+    {"invaders.h", 0x0000},
+    {"invaders.g", 0x0800},
+    {"invaders.f", 0x1000},
+    {"invaders.e", 0x1800},
+};
+
+
+int loadImage8080(Machine8080 *m, const char *path, uint16_t address)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0 || address + st.st_size > MEMORY_SIZE8080)
+    {
+        close(fd);
+        return 0;
+    }
+
+    long pageSize = sysconf(_SC_PAGESIZE);
+    int ok;
+    if (address % pageSize == 0 && st.st_size % pageSize == 0)
+    {
+        // Alias the file pages into the address space without copying; shared, so
+        // that mirrors can alias them too
+        void *mapped = mmap(m->memory + address, st.st_size, PROT_READ, MAP_SHARED | MAP_FIXED, fd, 0);
+        ok = mapped != MAP_FAILED;
+    }
+    else
+    {
+        ok = pread(fd, m->memory + address, st.st_size, 0) == st.st_size;
+    }
+    close(fd);
+
+    if (ok && address + st.st_size > m->romSize) m->romSize = address + st.st_size;
+    return ok && mapMemory8080(m, 256);
+}
+
+int loadRom8080(Machine8080 *m, const char *path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) return 0;
+    if (!S_ISDIR(st.st_mode)) return loadImage8080(m, path, 0x0000);
+
+    // Prefer the combined image, which can be mapped as a whole
+    char chipPath[4096];
+    snprintf(chipPath, sizeof(chipPath), "%s/invaders", path);
+    if (stat(chipPath, &st) == 0 && S_ISREG(st.st_mode))
+    {
+        if (!loadImage8080(m, chipPath, 0x0000)) return 0;
+    }
+    else
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            snprintf(chipPath, sizeof(chipPath), "%s/%s", path, invadersChips8080[i].name);
+            if (!loadImage8080(m, chipPath, invadersChips8080[i].address)) return 0;
+        }
+    }
+    return mapMemory8080(m, INVADERS_PAGES8080);
+}
@@ -0,0 +1,21 @@
+#ifndef ROM8080_H
+#define ROM8080_H
+
+#include <stdint.h>
+
+#include "cpu8080.h"
+
+// Map the ROM at path into the machine's memory. path is either a single image, placed at
+// 0x0000, or a directory holding the Space Invaders set: the combined invaders
+// image if present, otherwise the chips invaders.h/.g/.f/.e at
+// 0x0000/0x0800/0x1000/0x1800. The ROM is mapped read-only, and a directory
+// sets up the board's memory map with its mirrors (memory8080.h). Returns 0 on
+// failure.
+int loadRom8080(Machine8080 *m, const char *path);
+
+// Place one image at address. Page-aligned images are mmap'd read-only straight
+// into the address space, so every process running the ROM shares one physical
+// copy; anything smaller than a page has to be copied in.
+int loadImage8080(Machine8080 *m, const char *path, uint16_t address);
+
+#endif
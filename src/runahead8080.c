@@ -0,0 +1,57 @@
+#include <string.h>
+
+#include "runahead8080.h"
+#include "schedule8080.h"
+
+
+void initRunAhead8080(RunAhead8080 *r, int frames)
+{
+    memset(r, 0, sizeof(*r));
+    r->frames = frames;
+}
+
+void runAhead8080(RunAhead8080 *r, Machine8080 *m)
+{
+    uint64_t dirty[VRAM_DIRTY_WORDS8080];
+    IoBus8080 *bus = m->bus;
+    Profile8080 *profile = m->profile;
+    void (*watchHit)(Machine8080 *, Watchpoint8080 *, uint16_t, uint8_t, int) = m->watchHit;
+
+    saveState8080(m, &r->state);
+    memcpy(r->events, m->events, sizeof(r->events));
+    r->eventCount = m->eventCount;
+    r->romWrites = m->romWrites;
+    r->idleCycles = m->idleCycles;
+    memcpy(r->portReads, m->portReads, sizeof(r->portReads));
+    memcpy(r->portWrites, m->portWrites, sizeof(r->portWrites));
+
+    // Keep apart the lines the real frames changed and the ones the frames ahead do
+    takeVramDirty8080(m, dirty);
+    m->bus = NULL;
+    m->profile = NULL;
+    m->watchHit = NULL;
+    cancelDeviceEvents8080(m);
+    for (int i = 0; i < r->frames; i++) runFrame8080(m, 0);
+    m->bus = bus;
+    m->profile = profile;
+    m->watchHit = watchHit;
+
+    for (int i = 0; i < VRAM_DIRTY_WORDS8080; i++)
+    {
+        r->ahead[i] = m->vramDirty[i];
+        m->vramDirty[i] |= dirty[i];
+    }
+    r->runs++;
+}
+
+void restoreAhead8080(RunAhead8080 *r, Machine8080 *m)
+{
+    restoreState8080(m, &r->state);
+    memcpy(m->events, r->events, sizeof(m->events));
+    m->eventCount = r->eventCount;
+    m->romWrites = r->romWrites;
+    m->idleCycles = r->idleCycles;
+    memcpy(m->portReads, r->portReads, sizeof(m->portReads));
+    memcpy(m->portWrites, r->portWrites, sizeof(m->portWrites));
+    for (int i = 0; i < VRAM_DIRTY_WORDS8080; i++) m->vramDirty[i] |= r->ahead[i];
+}
@@ -0,0 +1,51 @@
+#ifndef RUNAHEAD8080_H
+#define RUNAHEAD8080_H
+
+#include <stdint.h>
+
+#include "cpu8080.h"
+#include "state8080.h"
+
+// Run-ahead: show the player a frame from the future. After each real frame the
+// machine is snapshotted and run a few frames further with the input held as it
+// is, that frame is presented, and the snapshot is restored. A button pressed
+// now then shows up on screen that many frames sooner than on the real board,
+// at the cost of emulating them on every frame. Most games ignore new input for
+// a frame or two anyway, so one or two frames ahead usually hide that lag.
+//
+// The frames run ahead are invisible to everything but the screen: they run
+// untraced and unprofiled, with the I/O bus detached so no sound is queued and
+// no device sees them, with watchpoint callbacks off, and with only the board's
+// interrupts left on the event queue, so no device event fires in a frame that
+// never happens. The statistics they would add to (port counts, ROM writes, idle
+// states skipped) are put back with the snapshot, and so is the event queue,
+// device events included, as the events the frames ahead ran have rescheduled
+// themselves past the real frame.
+
+typedef struct
+{
+    int frames;                                 // How far ahead to run
+    State8080 state;                            // The real machine, while ahead
+    uint64_t ahead[VRAM_DIRTY_WORDS8080];       // Lines the frames ahead stored to
+
+    // Event queue and statistics the snapshot does not hold
+    Event8080 events[EVENTS8080];
+    int eventCount;
+    uint64_t romWrites;
+    uint64_t idleCycles;
+    uint64_t portReads[256];
+    uint64_t portWrites[256];
+
+    uint64_t runs;
+} RunAhead8080;
+
+void initRunAhead8080(RunAhead8080 *r, int frames);
+// Snapshot m and run it r->frames frames ahead; m is left at the future frame
+// for the caller to present, with the lines changed since the last frame
+// presented marked dirty
+void runAhead8080(RunAhead8080 *r, Machine8080 *m);
+// Put m back at the real frame. The lines the future frame changed stay dirty,
+// so the next frame presented redraws them.
+void restoreAhead8080(RunAhead8080 *r, Machine8080 *m);
+
+#endif
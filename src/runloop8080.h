@@ -0,0 +1,71 @@
+// Batch run loops, included by cpu8080.c once per variant. The includer defines
+//   RUNLOOP_TABLE: name of the function-pointer loop
+//   RUNLOOP_GOTO:  name of the computed-goto loop
+//   RUNLOOP_TRACE: 1 to log every instruction into the binary trace, 0 for none
+//   RUNLOOP_PROFILE: 1 to feed every instruction to m->profile, 0 for none
+// Each loop executes instructions until budget states have passed, or until
+// m->target when a handler lowers it. Handlers of taken conditional CALL/RET add
+// their extra states to m->cycles themselves.
+
+uint64_t RUNLOOP_TABLE(Machine8080 *m, uint64_t budget)
+{
+    uint64_t start = m->cycles;
+    uint64_t instructions = 0;
+
+    m->target = start + budget;
+    while (m->cycles < m->target)
+    {
+        const uint8_t *instruction = &m->memory[m->pc];
+        const Dispatch8080 *entry = &dispatch8080[*instruction];
+        if (RUNLOOP_TRACE) traceRecord8080(m, instruction, m->cycles);
+        if (RUNLOOP_PROFILE) profileRecord8080(m, instruction, entry);
+        m->pc += entry->length;
+        m->cycles += entry->cycles;
+        instructions++;
+        entry->handler(m, instruction, entry);
+    }
+    m->instructions += instructions;
+    return m->cycles - start;
+}
+
+#ifdef __GNUC__
+uint64_t RUNLOOP_GOTO(Machine8080 *m, uint64_t budget)
+{
+    #define LABELADDRESS8080(name) &&label_##name,
+    static void *const labels[OP_KIND_COUNT] = { OPKINDS8080(LABELADDRESS8080) };
+    #undef LABELADDRESS8080
+    const uint8_t *instruction;
+    const Dispatch8080 *e;
+    uint64_t start = m->cycles;
+    uint64_t instructions = 0;
+
+    m->target = start + budget;
+
+    #define NEXT8080() \
+        if (m->cycles >= m->target) goto done; \
+        instruction = &m->memory[m->pc]; \
+        e = &dispatch8080[*instruction]; \
+        if (RUNLOOP_TRACE) traceRecord8080(m, instruction, m->cycles); \
+        if (RUNLOOP_PROFILE) profileRecord8080(m, instruction, e); \
+        m->pc += e->length; \
+        m->cycles += e->cycles; \
+        instructions++; \
+        goto *labels[e->kind]
+
+    NEXT8080();
+
+    #define LABELBODY8080(name) label_##name: op_##name(m, instruction, e); NEXT8080();
+    OPKINDS8080(LABELBODY8080)
+    #undef LABELBODY8080
+    #undef NEXT8080
+
+done:
+    m->instructions += instructions;
+    return m->cycles - start;
+}
+#else
+uint64_t RUNLOOP_GOTO(Machine8080 *m, uint64_t budget)
+{
+    return RUNLOOP_TABLE(m, budget);
+}
+#endif
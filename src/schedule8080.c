@@ -0,0 +1,74 @@
+#include <string.h>
+
+#include "schedule8080.h"
+
+
+int scheduleEvent8080(Machine8080 *m, uint64_t when, EventHandler8080 handler, void *device)
+{
+    if (m->eventCount == EVENTS8080) return 0;
+
+    int i = m->eventCount++;
+    for (; i > 0 && m->events[i - 1].when > when; i--) m->events[i] = m->events[i - 1];
+    m->events[i] = (Event8080) { when, handler, device };
+    return 1;
+}
+
+void cancelEvents8080(Machine8080 *m, EventHandler8080 handler, void *device)
+{
+    int kept = 0;
+
+    for (int i = 0; i < m->eventCount; i++)
+    {
+        if (m->events[i].handler != handler || m->events[i].device != device) m->events[kept++] = m->events[i];
+    }
+    m->eventCount = kept;
+}
+
+void runEvents8080(Machine8080 *m)
+{
+    while (m->eventCount > 0 && m->events[0].when <= m->cycles)
+    {
+        Event8080 event = m->events[0];
+        memmove(&m->events[0], &m->events[1], --m->eventCount * sizeof(Event8080));
+        event.handler(event.device, m, event.when);
+    }
+    if (m->pendingInterrupt >= 0 && m->interruptsEnabled) interrupt8080(m, m->pendingInterrupt);
+}
+
+static void midScreen8080(void *device, Machine8080 *m, uint64_t when)
+{
+    interrupt8080(m, 1);
+    scheduleEvent8080(m, when + FRAME_CYCLES8080, midScreen8080, device);
+}
+
+static void endOfFrame8080(void *device, Machine8080 *m, uint64_t when)
+{
+    interrupt8080(m, 2);
+    scheduleEvent8080(m, when + FRAME_CYCLES8080, endOfFrame8080, device);
+}
+
+void cancelDeviceEvents8080(Machine8080 *m)
+{
+    int kept = 0;
+
+    for (int i = 0; i < m->eventCount; i++)
+    {
+        if (m->events[i].handler == midScreen8080 || m->events[i].handler == endOfFrame8080) m->events[kept++] = m->events[i];
+    }
+    m->eventCount = kept;
+}
+
+void rebaseEvents8080(Machine8080 *m, uint64_t oldCycles)
+{
+    uint64_t frameEnd = (m->cycles / FRAME_CYCLES8080 + 1) * FRAME_CYCLES8080;
+    uint64_t middle = frameEnd - FRAME_CYCLES8080 / 2;
+
+    cancelEvents8080(m, midScreen8080, NULL);
+    cancelEvents8080(m, endOfFrame8080, NULL);
+    // Unsigned arithmetic wraps back into place when the machine went back in time
+    for (int i = 0; i < m->eventCount; i++) m->events[i].when += m->cycles - oldCycles;
+
+    // The middle of this frame may be behind already; the next one is then a frame on
+    scheduleEvent8080(m, m->cycles < middle ? middle : middle + FRAME_CYCLES8080, midScreen8080, NULL);
+    scheduleEvent8080(m, frameEnd, endOfFrame8080, NULL);
+}
@@ -0,0 +1,47 @@
+#ifndef SCHEDULE8080_H
+#define SCHEDULE8080_H
+
+#include <stdint.h>
+
+#include "cpu8080.h"
+
+// Event scheduler. A machine keeps its future events in m->events, a short array
+// sorted by cycle count. runFrame8080 hands the engine the states up to the
+// soonest one and lets it run uninterrupted until then; nothing is checked
+// between instructions but the end of the run. runEvents8080 then calls the
+// handlers of every event that has come due, in order, and takes a pending
+// interrupt if interrupts are enabled again.
+//
+// The board schedules its two video interrupts as events of its own, each
+// rescheduling itself a frame later: RST 1 when the beam reaches the middle of
+// the screen and RST 2 at the end of the frame, half a frame apart. Devices can
+// schedule their own, such as sound timing or input sampling, and a handler may
+// reschedule itself from the when it was due, so periodic events do not drift.
+//
+// The board's events are worked out again from the cycle count on reset and
+// whenever a save state is loaded. Device events keep how far in the future they
+// were, so a device's timing is unaffected by a load. Frames run only to be
+// thrown away, as run-ahead does, run with the device events taken off the queue.
+
+// Add an event; events due at the same time run in the order they were
+// scheduled. Returns 0 when the queue is full.
+int scheduleEvent8080(Machine8080 *m, uint64_t when, EventHandler8080 handler, void *device);
+// Drop every event of handler for device
+void cancelEvents8080(Machine8080 *m, EventHandler8080 handler, void *device);
+// Drop every event but the board's interrupts
+void cancelDeviceEvents8080(Machine8080 *m);
+// Run the handlers of the events due at m->cycles or before, then take the
+// pending interrupt if interrupts are enabled
+void runEvents8080(Machine8080 *m);
+// After m->cycles changed from oldCycles behind the scheduler's back (a reset or
+// a load): schedule the board's interrupts for the new time and move the other
+// events by as much
+void rebaseEvents8080(Machine8080 *m, uint64_t oldCycles);
+
+// When the next event is due, or limit if that is sooner
+static inline uint64_t nextEvent8080(const Machine8080 *m, uint64_t limit)
+{
+    return m->eventCount > 0 && m->events[0].when < limit ? m->events[0].when : limit;
+}
+
+#endif
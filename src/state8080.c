@@ -0,0 +1,64 @@
+#include <string.h>
+
+#include "block8080.h"
+#include "schedule8080.h"
+#include "state8080.h"
+
+
+void saveState8080(Machine8080 *m, State8080 *s)
+{
+    s->version = STATE_VERSION8080;
+    s->romSize = m->romSize;
+    memcpy(s->registers, m->registers, sizeof(s->registers));
+    s->flags = getFlags8080(m);
+    s->interruptsEnabled = m->interruptsEnabled;
+    s->halted = m->halted;
+    s->pendingInterrupt = m->pendingInterrupt + 1;
+    memcpy(s->input, m->input, sizeof(s->input));
+    s->shiftOffset = m->shiftOffset;
+    s->shift = m->shift;
+    s->reserved = 0;
+    memset(s->reserved2, 0, sizeof(s->reserved2));
+    s->SP = m->SP;
+    s->pc = m->pc;
+    s->cycles = m->cycles;
+    s->instructions = m->instructions;
+    memcpy(s->ram, m->memory + RAM_START8080, RAM_SIZE8080);
+}
+
+int restoreState8080(Machine8080 *m, const State8080 *s)
+{
+    uint64_t oldCycles = m->cycles;
+
+    if (s->version != STATE_VERSION8080 || s->romSize != m->romSize) return 0;
+
+    memcpy(m->registers, s->registers, sizeof(m->registers));
+    setFlags8080(m, s->flags);
+    m->interruptsEnabled = s->interruptsEnabled;
+    m->halted = s->halted;
+    m->pendingInterrupt = s->pendingInterrupt - 1;
+    memcpy(m->input, s->input, sizeof(m->input));
+    m->shiftOffset = s->shiftOffset;
+    m->shift = s->shift;
+    m->SP = s->SP;
+    m->pc = s->pc;
+    m->cycles = s->cycles;
+    m->instructions = s->instructions;
+    m->idleBranch = -1;
+    rebaseEvents8080(m, oldCycles);
+    memcpy(m->memory + RAM_START8080, s->ram, RAM_SIZE8080);
+
+    // The RAM was replaced behind the store path: drop blocks cached from it
+    for (int page = RAM_START8080 >> 8; page < (RAM_START8080 + RAM_SIZE8080) >> 8; page++)
+    {
+        if ((m->codePages[page >> 6] >> (page & 63)) & 1) invalidateCode8080(m, page << 8);
+    }
+    return 1;
+}
+
+int loadState8080(Machine8080 *m, const State8080 *s)
+{
+    if (!restoreState8080(m, s)) return 0;
+    memset(m->vramDirty, 0xFF, sizeof(m->vramDirty));
+    return 1;
+}
@@ -0,0 +1,49 @@
+#ifndef STATE8080_H
+#define STATE8080_H
+
+#include <stdint.h>
+
+#include "cpu8080.h"
+
+// Save states. A snapshot holds everything that changes while the machine runs:
+// the registers, flags, SP, pc, the cycle and instruction counts the interrupt
+// timing is derived from, the interrupt state and any pending interrupt, the
+// input ports, the shift register and the writable RAM. The ROM is not copied; a
+// snapshot can only be loaded into a machine with the same ROM. Attached I/O
+// devices and the events they scheduled are not part of it either; loading one
+// reschedules the board's interrupts from its cycle count (schedule8080.h).
+
+#define STATE_VERSION8080 3
+
+typedef struct
+{
+    uint32_t version;
+    uint32_t romSize;
+    uint8_t registers[8];       // Same layout as Machine8080.registers
+    uint8_t flags;              // Flag byte as PUSH PSW would store it
+    uint8_t interruptsEnabled;
+    uint8_t halted;
+    uint8_t input[2];
+    uint8_t shiftOffset;
+    uint8_t pendingInterrupt;   // RST vector + 1, or 0 for none (as older snapshots have)
+    uint8_t reserved;
+    uint16_t SP;
+    uint16_t pc;
+    uint16_t shift;
+    uint8_t reserved2[2];
+    uint64_t cycles;
+    uint64_t instructions;
+    uint8_t ram[RAM_SIZE8080];  // RAM_START8080 onwards
+} State8080;
+
+// No padding, so snapshots can be hashed and diffed as plain bytes
+_Static_assert(sizeof(State8080) == 48 + RAM_SIZE8080, "save states must stay packed");
+
+void saveState8080(Machine8080 *m, State8080 *s);
+// Returns 0, leaving the machine alone, when the snapshot is from another ROM or version
+int loadState8080(Machine8080 *m, const State8080 *s);
+// loadState8080 without marking the whole screen dirty, for callers that know
+// which video RAM lines the snapshot differs in and mark those themselves
+int restoreState8080(Machine8080 *m, const State8080 *s);
+
+#endif
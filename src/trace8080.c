@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "trace8080.h"
+
+Trace8080 trace8080;
+
+
+int openTrace8080(const char *path, uint32_t capacity, int ring)
+{
+    TraceHeader8080 header = { TRACE_MAGIC, sizeof(TraceRecord8080), 0 };
+
+    trace8080.records = malloc((size_t) capacity * sizeof(TraceRecord8080));
+    if (trace8080.records == NULL) return 0;
+    trace8080.file = fopen(path, "wb");
+    if (trace8080.file == NULL)
+    {
+        free(trace8080.records);
+        trace8080.records = NULL;
+        return 0;
+    }
+    fwrite(&header, sizeof(header), 1, trace8080.file);
+
+    trace8080.capacity = capacity;
+    trace8080.head = 0;
+    trace8080.wrapped = 0;
+    trace8080.ring = ring;
+    return 1;
+}
+
+void wrapTrace8080(void)
+{
+    if (!trace8080.ring)
+    {
+        fwrite(trace8080.records, sizeof(TraceRecord8080), trace8080.capacity, trace8080.file);
+    }
+    trace8080.wrapped = 1;
+    trace8080.head = 0;
+}
+
+void closeTrace8080(void)
+{
+    if (trace8080.file == NULL) return;
+
+    // In ring mode the oldest record sits right after the newest one
+    if (trace8080.ring && trace8080.wrapped)
+    {
+        fwrite(&trace8080.records[trace8080.head], sizeof(TraceRecord8080), trace8080.capacity - trace8080.head, trace8080.file);
+    }
+    fwrite(trace8080.records, sizeof(TraceRecord8080), trace8080.head, trace8080.file);
+
+    fclose(trace8080.file);
+    free(trace8080.records);
+    trace8080.file = NULL;
+    trace8080.records = NULL;
+}
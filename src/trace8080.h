@@ -0,0 +1,74 @@
+#ifndef TRACE8080_H
+#define TRACE8080_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cpu8080.h"
+
+// Binary execution trace. Every executed instruction becomes one fixed-size record
+// in a preallocated ring; the ring is either flushed to a file in whole blocks when
+// it fills up, or (flight recorder mode) keeps only the newest records in memory
+// and writes them out when the trace is closed. tracedump turns a trace file back
+// into text.
+
+#define TRACE_MAGIC "8080TRC1"
+#define TRACE_DEFAULT_RECORDS (1 << 16)
+
+// Machine state just before the instruction executes
+typedef struct
+{
+    uint16_t pc;
+    uint8_t opcode[3];          // Opcode and both possible operand bytes
+    uint8_t flags;
+    uint8_t registers[8];       // Same layout as Machine8080.registers
+    uint16_t sp;
+    uint64_t cycles;            // States executed before this instruction
+} TraceRecord8080;
+
+_Static_assert(sizeof(TraceRecord8080) == 24, "trace records must stay packed");
+
+// Header at the start of every trace file
+typedef struct
+{
+    char magic[8];
+    uint32_t recordSize;
+    uint32_t reserved;
+} TraceHeader8080;
+
+typedef struct
+{
+    TraceRecord8080 *records;
+    uint32_t capacity;          // Number of records in the ring
+    uint32_t head;              // Next slot to fill
+    int wrapped;                // Ring mode: the ring has been overwritten at least once
+    FILE *file;
+    int ring;                   // Keep only the newest records instead of streaming
+} Trace8080;
+
+extern Trace8080 trace8080;
+
+// Start tracing into path with a ring of capacity records. With ring set, only the
+// newest capacity records are kept and written when the trace is closed. Returns
+// 0 if the file cannot be written or the ring allocated.
+int openTrace8080(const char *path, uint32_t capacity, int ring);
+void closeTrace8080(void);
+// Called when the ring is full
+void wrapTrace8080(void);
+
+static inline void traceRecord8080(Machine8080 *m, const uint8_t *instruction, uint64_t cycles)
+{
+    TraceRecord8080 *record = &trace8080.records[trace8080.head];
+
+    record->pc = m->pc;
+    memcpy(record->opcode, instruction, 3);
+    record->flags = getFlags8080(m);
+    memcpy(record->registers, m->registers, 8);
+    record->sp = m->SP;
+    record->cycles = cycles;
+
+    if (++trace8080.head == trace8080.capacity) wrapTrace8080();
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "disasm8080.h"
+#include "trace8080.h"
+
+// Offline decoder for binary execution traces written by the emulator. Prints one
+// line per instruction in the disassembler's format; -r adds the register state.
+
+#define BLOCK_RECORDS 4096
+
+
+int main(int argc, char** argv)
+{
+    int showRegisters = 0;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-r") == 0) showRegisters = 1;
+        else path = argv[i];
+    }
+    if (path == NULL) {
+        printf("usage: %s [-r] trace\n", argv[0]);
+        exit(1);
+    }
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        printf("error: could not read file %s\n", path);
+        exit(2);
+    }
+
+    TraceHeader8080 header;
+    if (fread(&header, sizeof(header), 1, f) != 1 || memcmp(header.magic, TRACE_MAGIC, 8) != 0
+        || header.recordSize != sizeof(TraceRecord8080))
+    {
+        printf("error: %s is not an 8080 trace\n", path);
+        exit(3);
+    }
+
+    static char output[1 << 20];
+    setvbuf(stdout, output, _IOFBF, sizeof(output));
+
+    TraceRecord8080 *records = malloc(BLOCK_RECORDS * sizeof(TraceRecord8080));
+    size_t count;
+    while ((count = fread(records, sizeof(TraceRecord8080), BLOCK_RECORDS, f)) > 0)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            TraceRecord8080 *r = &records[i];
+            printf("%04X    ", r->pc);
+            disassembleOp8080(r->opcode, 0);
+            if (showRegisters)
+            {
+                printf("        A=%02X B=%02X C=%02X D=%02X E=%02X H=%02X L=%02X SP=%04X F=%02X CYC=%llu\n",
+                       r->registers[7], r->registers[0], r->registers[1], r->registers[2], r->registers[3],
+                       r->registers[4], r->registers[5], r->sp, r->flags, (unsigned long long) r->cycles);
+            }
+        }
+    }
+
+    free(records);
+    fclose(f);
+    return 0;
+}
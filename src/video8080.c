@@ -0,0 +1,274 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "video8080.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define X86_8080 1
+#endif
+
+// The colour film on the cabinet glass: lit pixels inside a band take its colour,
+// everything else stays white
+static const struct
+{
+    int top, bottom, left, right;
+    uint32_t colour;
+} overlay8080[] = {
+    {  32,  64,  0, 224, RGBA8080(0xFF, 0x20, 0x20) },    // Red strip over the saucer
+    { 184, 240,  0, 224, RGBA8080(0x20, 0xFF, 0x20) },    // Green over the shields and the base
+    { 240, 256, 16, 134, RGBA8080(0x20, 0xFF, 0x20) },    // and over the spare bases, not the credits
+};
+
+
+int kernelSupported8080(int kernel)
+{
+    switch (kernel)
+    {
+        case KERNEL_SCALAR8080: return 1;
+#ifdef X86_8080
+        case KERNEL_SSE2_8080: return __builtin_cpu_supports("sse2");
+        case KERNEL_AVX2_8080: return __builtin_cpu_supports("avx2");
+#endif
+        default: return 0;
+    }
+}
+
+int initVideo8080(Video8080 *v, int format)
+{
+    size_t size = SCREEN_WIDTH8080 * SCREEN_HEIGHT8080 * (format == PIXELS_GRAY8080 ? 1 : 4);
+
+    memset(v, 0, sizeof(*v));
+    v->format = format;
+    v->pixels = aligned_alloc(64, size);
+    if (v->pixels == NULL) return 0;
+    memset(v->pixels, 0, size);
+
+    for (int kernel = 0; kernel < KERNEL_COUNT8080; kernel++)
+    {
+        if (kernelSupported8080(kernel)) v->kernel = kernel;
+    }
+
+    for (int x = 0; x < SCREEN_WIDTH8080; x++) v->bands[0][x] = RGBA8080(0xFF, 0xFF, 0xFF);
+    for (int y = 0; y < SCREEN_HEIGHT8080; y++) v->rows[y] = v->bands[0];
+    if (format == PIXELS_OVERLAY8080)
+    {
+        for (int band = 0; band < (int) (sizeof(overlay8080) / sizeof(overlay8080[0])); band++)
+        {
+            uint32_t *row = v->bands[band + 1];
+            for (int x = 0; x < SCREEN_WIDTH8080; x++)
+            {
+                row[x] = x >= overlay8080[band].left && x < overlay8080[band].right ? overlay8080[band].colour : v->bands[0][x];
+            }
+            for (int y = overlay8080[band].top; y < overlay8080[band].bottom; y++) v->rows[y] = row;
+        }
+    }
+    return 1;
+}
+
+void freeVideo8080(Video8080 *v)
+{
+    free(v->pixels);
+    v->pixels = NULL;
+}
+
+// Screen row of bit of video byte byteIndex: the first byte of a column is at the bottom
+static inline int screenRow8080(int byteIndex, int bit)
+{
+    return SCREEN_HEIGHT8080 - 1 - (byteIndex * 8 + bit);
+}
+
+// Dirty bits of the count columns from x on; x is a multiple of count, count <= 32
+static inline uint64_t dirtyColumns8080(const uint64_t *dirty, int x, int count)
+{
+    return (dirty[x / 64] >> (x % 64)) & ((1ULL << count) - 1);
+}
+
+// Scalar: gather the same byte of 8 columns, transpose the 8x8 bit matrix so each
+// byte holds one screen row of those columns, then expand
+static void convertScalar8080(Video8080 *v, const uint8_t *vram, const uint64_t *dirty)
+{
+    uint8_t *restrict pixels = v->pixels;
+    const uint32_t *const *restrict rows = v->rows;
+    int gray = v->format == PIXELS_GRAY8080;
+
+    for (int byteIndex = 0; byteIndex < VRAM_COLUMN8080; byteIndex++)
+    {
+        for (int x = 0; x < SCREEN_WIDTH8080; x += 8)
+        {
+            if (!dirtyColumns8080(dirty, x, 8)) continue;
+
+            uint64_t bits = 0;
+            for (int i = 0; i < 8; i++) bits |= (uint64_t) vram[(x + i) * VRAM_COLUMN8080 + byteIndex] << (i * 8);
+
+            uint64_t t;
+            t = (bits ^ (bits >> 7)) & 0x00AA00AA00AA00AAULL;
+            bits ^= t ^ (t << 7);
+            t = (bits ^ (bits >> 14)) & 0x0000CCCC0000CCCCULL;
+            bits ^= t ^ (t << 14);
+            t = (bits ^ (bits >> 28)) & 0x00000000F0F0F0F0ULL;
+            bits ^= t ^ (t << 28);
+
+            for (int bit = 0; bit < 8; bit++)
+            {
+                int y = screenRow8080(byteIndex, bit);
+                uint8_t lit = bits >> (bit * 8);
+
+                if (gray)
+                {
+                    // Bit i into byte i, then each non-zero byte to 0xFF (little-endian)
+                    uint64_t spread = (lit * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+                    uint64_t expanded = (((spread + 0x7F7F7F7F7F7F7F7FULL) | spread) >> 7 & 0x0101010101010101ULL) * 0xFF;
+                    memcpy(pixels + y * SCREEN_WIDTH8080 + x, &expanded, 8);
+                    continue;
+                }
+                uint32_t *out = (uint32_t *) pixels + y * SCREEN_WIDTH8080 + x;
+                for (int i = 0; i < 8; i++) out[i] = rows[y][x + i] & -(uint32_t) ((lit >> i) & 1);
+            }
+        }
+    }
+}
+
+#ifdef X86_8080
+// Four rounds of interleaving rows i and i + 8 transpose a 16x16 byte matrix:
+// each round rotates the 8-bit (row, column) index left by one bit
+#define TRANSPOSE8080(type, unpacklo, unpackhi, rows) \
+    do \
+    { \
+        type t[16]; \
+        _Pragma("GCC unroll 4") \
+        for (int round = 0; round < 4; round++) \
+        { \
+            _Pragma("GCC unroll 8") \
+            for (int i = 0; i < 8; i++) \
+            { \
+                t[2 * i] = unpacklo(rows[i], rows[i + 8]); \
+                t[2 * i + 1] = unpackhi(rows[i], rows[i + 8]); \
+            } \
+            memcpy(rows, t, sizeof(t)); \
+        } \
+    } while (0)
+
+// 16 columns of one video byte, as 16 screen pixels on each of its 8 rows
+__attribute__((target("sse2")))
+static inline void emitSse2_8080(uint8_t *restrict pixels, const uint32_t *const *restrict rows, int gray, __m128i bytes, int byteIndex, int x)
+{
+    for (int bit = 0; bit < 8; bit++)
+    {
+        int y = screenRow8080(byteIndex, bit);
+        __m128i select = _mm_set1_epi8((char) (1 << bit));
+        __m128i lit = _mm_cmpeq_epi8(_mm_and_si128(bytes, select), select);
+
+        if (gray)
+        {
+            _mm_storeu_si128((__m128i *) (pixels + y * SCREEN_WIDTH8080 + x), lit);
+            continue;
+        }
+        const __m128i *colour = (const __m128i *) (rows[y] + x);
+        __m128i *out = (__m128i *) (pixels + (y * SCREEN_WIDTH8080 + x) * 4);
+        __m128i low = _mm_unpacklo_epi8(lit, lit);
+        __m128i high = _mm_unpackhi_epi8(lit, lit);
+        _mm_storeu_si128(out + 0, _mm_and_si128(_mm_unpacklo_epi16(low, low), _mm_load_si128(colour + 0)));
+        _mm_storeu_si128(out + 1, _mm_and_si128(_mm_unpackhi_epi16(low, low), _mm_load_si128(colour + 1)));
+        _mm_storeu_si128(out + 2, _mm_and_si128(_mm_unpacklo_epi16(high, high), _mm_load_si128(colour + 2)));
+        _mm_storeu_si128(out + 3, _mm_and_si128(_mm_unpackhi_epi16(high, high), _mm_load_si128(colour + 3)));
+    }
+}
+
+// SSE2: 16 columns by 16 bytes at a time. Each half of the video bytes covers
+// 128 screen rows, small enough for the rows to be completed in cache before
+// moving on.
+__attribute__((target("sse2")))
+static void convertSse2_8080(Video8080 *v, const uint8_t *vram, const uint64_t *dirty)
+{
+    __m128i columns[16];
+    uint8_t *pixels = v->pixels;
+    int gray = v->format == PIXELS_GRAY8080;
+
+    for (int half = 0; half < VRAM_COLUMN8080; half += 16)
+    {
+        for (int x = 0; x < SCREEN_WIDTH8080; x += 16)
+        {
+            if (!dirtyColumns8080(dirty, x, 16)) continue;
+            for (int i = 0; i < 16; i++) columns[i] = _mm_loadu_si128((const __m128i *) (vram + (x + i) * VRAM_COLUMN8080 + half));
+            TRANSPOSE8080(__m128i, _mm_unpacklo_epi8, _mm_unpackhi_epi8, columns);
+            for (int i = 0; i < 16; i++) emitSse2_8080(pixels, v->rows, gray, columns[i], half + i, x);
+        }
+    }
+}
+
+// 32 columns of one video byte, as 32 screen pixels on each of its 8 rows
+__attribute__((target("avx2")))
+static inline void emitAvx2_8080(uint8_t *restrict pixels, const uint32_t *const *restrict rows, int gray, __m256i bytes, int byteIndex, int x)
+{
+    for (int bit = 0; bit < 8; bit++)
+    {
+        int y = screenRow8080(byteIndex, bit);
+        __m256i select = _mm256_set1_epi8((char) (1 << bit));
+        __m256i lit = _mm256_cmpeq_epi8(_mm256_and_si256(bytes, select), select);
+
+        if (gray)
+        {
+            _mm256_storeu_si256((__m256i *) (pixels + y * SCREEN_WIDTH8080 + x), lit);
+            continue;
+        }
+        const __m256i *colour = (const __m256i *) (rows[y] + x);
+        __m256i *out = (__m256i *) (pixels + (y * SCREEN_WIDTH8080 + x) * 4);
+        __m128i low = _mm256_castsi256_si128(lit);
+        __m128i high = _mm256_extracti128_si256(lit, 1);
+        _mm256_storeu_si256(out + 0, _mm256_and_si256(_mm256_cvtepi8_epi32(low), _mm256_load_si256(colour + 0)));
+        _mm256_storeu_si256(out + 1, _mm256_and_si256(_mm256_cvtepi8_epi32(_mm_srli_si128(low, 8)), _mm256_load_si256(colour + 1)));
+        _mm256_storeu_si256(out + 2, _mm256_and_si256(_mm256_cvtepi8_epi32(high), _mm256_load_si256(colour + 2)));
+        _mm256_storeu_si256(out + 3, _mm256_and_si256(_mm256_cvtepi8_epi32(_mm_srli_si128(high, 8)), _mm256_load_si256(colour + 3)));
+    }
+}
+
+// AVX2: columns x..x+15 in the low lane and x+16..x+31 in the high one. The unpacks
+// work within each 128-bit lane, so both 16x16 transposes run side by side and
+// every result register is 32 adjacent pixels of one row.
+__attribute__((target("avx2")))
+static void convertAvx2_8080(Video8080 *v, const uint8_t *vram, const uint64_t *dirty)
+{
+    __m256i columns[16];
+    uint8_t *pixels = v->pixels;
+    int gray = v->format == PIXELS_GRAY8080;
+
+    for (int half = 0; half < VRAM_COLUMN8080; half += 16)
+    {
+        for (int x = 0; x < SCREEN_WIDTH8080; x += 32)
+        {
+            if (!dirtyColumns8080(dirty, x, 32)) continue;
+            for (int i = 0; i < 16; i++)
+            {
+                __m128i low = _mm_loadu_si128((const __m128i *) (vram + (x + i) * VRAM_COLUMN8080 + half));
+                __m128i high = _mm_loadu_si128((const __m128i *) (vram + (x + 16 + i) * VRAM_COLUMN8080 + half));
+                columns[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+            }
+            TRANSPOSE8080(__m256i, _mm256_unpacklo_epi8, _mm256_unpackhi_epi8, columns);
+            for (int i = 0; i < 16; i++) emitAvx2_8080(pixels, v->rows, gray, columns[i], half + i, x);
+        }
+    }
+}
+#endif
+
+void updateFrame8080(Video8080 *v, const Machine8080 *m, const uint64_t dirty[VRAM_DIRTY_WORDS8080])
+{
+    const uint8_t *vram = m->memory + VRAM_START8080;
+
+    switch (v->kernel)
+    {
+#ifdef X86_8080
+        case KERNEL_AVX2_8080: convertAvx2_8080(v, vram, dirty); break;
+        case KERNEL_SSE2_8080: convertSse2_8080(v, vram, dirty); break;
+#endif
+        default: convertScalar8080(v, vram, dirty); break;
+    }
+}
+
+void convertFrame8080(Video8080 *v, const Machine8080 *m)
+{
+    uint64_t all[VRAM_DIRTY_WORDS8080];
+
+    memset(all, 0xFF, sizeof(all));
+    updateFrame8080(v, m, all);
+}
@@ -0,0 +1,60 @@
+#ifndef VIDEO8080_H
+#define VIDEO8080_H
+
+#include <stdint.h>
+
+#include "cpu8080.h"
+
+// Each 32-byte video RAM line is one column of 256 pixels, bit 0 of its first byte
+// at the bottom. The monitor is mounted rotated, so the picture is 224 pixels wide
+// and 256 high.
+#define SCREEN_WIDTH8080 224
+#define SCREEN_HEIGHT8080 256
+
+// RGBA pixels are stored as bytes R, G, B, A; the macro gives the uint32_t with
+// that layout on a little-endian host
+#define RGBA8080(r, g, b) ((uint32_t) (r) | (uint32_t) (g) << 8 | (uint32_t) (b) << 16 | 0xFF000000u)
+
+enum
+{
+    PIXELS_GRAY8080,        // 1 byte per pixel, 0x00 or 0xFF
+    PIXELS_RGBA8080,        // 4 bytes per pixel, black and white
+    PIXELS_OVERLAY8080,     // 4 bytes per pixel, lit pixels tinted by the cabinet's colour bands
+};
+
+// Transpose kernel used by convertFrame8080
+enum
+{
+    KERNEL_SCALAR8080,
+    KERNEL_SSE2_8080,
+    KERNEL_AVX2_8080,
+    KERNEL_COUNT8080
+};
+
+typedef struct
+{
+    int format;
+    int kernel;             // Fastest one the host supports, unless changed after initVideo8080
+    void *pixels;           // SCREEN_HEIGHT8080 rows of SCREEN_WIDTH8080 pixels, top row first
+
+    // Colour of a lit pixel, per row and column: rows[y] points into one of the
+    // few distinct colour rows in bands
+    const uint32_t *rows[SCREEN_HEIGHT8080];
+    _Alignas(32) uint32_t bands[4][SCREEN_WIDTH8080];
+} Video8080;
+
+// Allocate the pixel buffer for format and pick the transpose kernel. Returns 0 on failure.
+int initVideo8080(Video8080 *v, int format);
+void freeVideo8080(Video8080 *v);
+// Returns 0 when the kernel is not available on this host
+int kernelSupported8080(int kernel);
+
+// Turn the machine's video RAM into v->pixels
+void convertFrame8080(Video8080 *v, const Machine8080 *m);
+// The same for only the columns whose lines are set in dirty, as returned by
+// takeVramDirty8080; the rest of v->pixels is left as it was. The kernels work on
+// groups of 8, 16 or 32 columns, so clean neighbours of a dirty column may be
+// redone too.
+void updateFrame8080(Video8080 *v, const Machine8080 *m, const uint64_t dirty[VRAM_DIRTY_WORDS8080]);
+
+#endif